@@ -0,0 +1,582 @@
+/**
+ * Snake Game - AI Controllers
+ *
+ * The Monte Carlo tree search controller works like this:
+ *   1. Every tick, each search thread clones the current game into its arena.
+ *   2. It walks down its own search tree, picking moves with the UCB1 formula,
+ *      and plays them out on the clone.
+ *   3. From the first new tree node it plays a quick random "rollout" game
+ *      and scores how well the snake did (survival and food eaten).
+ *   4. The score is added to every node on the path, and every move is
+ *      undone again so the clone is back at the root for the next rollout.
+ * When the time budget runs out the visit counts of the three root moves are
+ * summed over all threads and the most visited move is played.
+ *
+ * The threads build separate trees, but they all search the same root, so
+ * they keep reaching the same states. New leaves are looked up in a
+ * transposition table all the threads share (see ttable.h), keyed by the
+ * state hash and the ply; once a state has enough results there, their mean
+ * stands in for the rollout, and every rollout adds its result back.
+ *
+ * Moves are relative to the current heading (turn left, go straight, turn
+ * right), so the reversal that handleKey() blocks is never considered.
+ * The tree is "open loop": nodes stand for move sequences, not exact states,
+ * because the food appears at a random spot each time it is eaten.
+ *
+ * The heuristic controller is much cheaper: it scores each of the three moves
+ * with a weighted sum of a few features (see ai.h) and takes the best one.
+ * Its weights can be tuned with the snake-train tool.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ai.h"
+
+/* Food eaten one tick later is worth this much less */
+#define MCTS_DISCOUNT 0.9f
+
+/* Shared transposition table: its size, and how many results a state needs
+ * before their mean is used instead of a rollout */
+#define MCTS_TABLE_BYTES (4 << 20)
+#define MCTS_TABLE_TRUST 4
+
+/* Arena space for the root clone: the game, its occupancy and free-at grids
+ * and a body ring that can grow by one segment per simulated tick */
+#define MCTS_ARENA_BYTES \
+    (sizeof(Game) + GRID_WORDS * sizeof(uint64_t) + CELL_COUNT * sizeof(int) + \
+     2 * (CELL_COUNT + MCTS_ROLLOUT_DEPTH) * sizeof(Point) + 4 * ARENA_ALIGN)
+
+/* One node of a search tree */
+typedef struct {
+    int child[3];   // Tree index for each relative move, -1 if not expanded
+    int visits;     // Number of rollouts that passed through this node
+    float value;    // Sum of rollout rewards
+} MctsNode;
+
+/* Per-thread search state, reused every tick so searching never allocates.
+ * Each worker gets cache lines of its own, so the counters one thread bumps
+ * on every rollout do not share a line with the next worker's fields. */
+typedef struct {
+    MctsController *owner;
+    pthread_t thread;
+    Arena arena;               // Holds this tick's clone of the root game
+    MoveUndo undo[MCTS_ROLLOUT_DEPTH];  // Moves played in the current rollout
+    MctsNode *nodes;           // Node pool of MCTS_MAX_NODES entries
+    int nodeCount;
+    uint64_t rng;
+    long rollouts;
+    TableStats tableStats;     // This thread's use of the shared table
+} __attribute__((aligned(64))) MctsWorker;
+
+struct MctsController {
+    int threadCount;
+    int budgetMs;
+    MctsWorker workers[MCTS_MAX_THREADS];
+    TransTable table;          // Shared by all the workers, without locking
+
+    /* Shared search request, protected by lock */
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    const Game *root;
+    struct timespec deadline;
+    unsigned long generation;  // Bumped for every new search
+    int running;               // Helper threads still searching
+    bool shutdown;
+
+    long lastRollouts;
+    TableStats lastTableStats;
+};
+
+/* Turn a relative move (0 = left, 1 = straight, 2 = right) into a direction */
+static int relativeToDirection(int heading, int move) {
+    return (heading + 3 + move) % 4;
+}
+
+/* Distance between two points on the wrap-around board */
+static int wrapDistance(Point a, Point b) {
+    int inner_w = WIDTH - 2;
+    int inner_h = HEIGHT - 2;
+    int dx = abs(a.x - b.x);
+    int dy = abs(a.y - b.y);
+
+    if (dx > inner_w - dx) dx = inner_w - dx;
+    if (dy > inner_h - dy) dy = inner_h - dy;
+    return dx + dy;
+}
+
+/* True once the current time has passed the deadline */
+static bool pastDeadline(const struct timespec *deadline) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > deadline->tv_sec ||
+           (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+/* Pick a move for a rollout: avoid the body, and usually head for the food */
+static int rolloutMove(const Game *game, uint64_t *rng) {
+    const Snake *snake = &game->snake;
+    int safe[3];
+    int safeCount = 0;
+    int best = -1;
+    int bestDistance = WIDTH + HEIGHT;
+
+    for (int move = 0; move < 3; move++) {
+        int dir = relativeToDirection(snake->direction, move);
+        Point next = nextHead(snake, dir);
+
+        /* The tail moves away this tick (unless it has just grown) */
+        if (!cellSafeAt(snake, next, 1)) {
+            continue;
+        }
+        safe[safeCount++] = dir;
+
+        int distance = wrapDistance(next, game->food);
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = dir;
+        }
+    }
+
+    /* Boxed in: keep going straight and accept the collision */
+    if (safeCount == 0) {
+        return snake->direction;
+    }
+    if (gameRandom(rng) & 1) {
+        return best;
+    }
+    return safe[gameRandom(rng) % safeCount];
+}
+
+/* Play random moves from the current state and score what happens from
+ * here on: survival, plus the food eaten on the way. Food is worth less the
+ * later it is eaten, so eating sooner wins. The food eaten before this state
+ * is not included (see addPathFood()), so the score depends only on the
+ * state and the ply, and can be shared through the transposition table.
+ * 'depth' counts the moves recorded in the worker's undo log. */
+static float rollout(MctsWorker *worker, Game *game, int *depth) {
+    float discount = powf(MCTS_DISCOUNT, (float)*depth);
+    float foodScore = 0.0f;
+
+    while (!game->gameOver && *depth < MCTS_ROLLOUT_DEPTH) {
+        int dir = rolloutMove(game, &worker->rng);
+        discount *= MCTS_DISCOUNT;
+        if (applyMove(game, dir, &worker->undo[(*depth)++])) {
+            foodScore += discount;
+        }
+    }
+
+    /* Filling the board is the best possible outcome */
+    if (game->won) {
+        return 1.0f;
+    }
+
+    float survival = game->gameOver ? 0.5f * *depth / MCTS_ROLLOUT_DEPTH : 1.0f;
+    return 0.5f * survival + 0.5f * foodScore;
+}
+
+/* The full reward of a simulation in [0, 1]: the rollout's score plus the
+ * food eaten on the tree path above it */
+static float addPathFood(float rolloutScore, float foodScore) {
+    float reward = rolloutScore + 0.5f * foodScore;
+    return reward < 1.0f ? reward : 1.0f;
+}
+
+/* Choose the child with the best UCB1 score, trying unvisited ones first */
+static int selectMove(const MctsWorker *worker, const MctsNode *node) {
+    int bestMove = 0;
+    float bestScore = -1.0f;
+    float logVisits = logf((float)node->visits + 1.0f);
+
+    for (int move = 0; move < 3; move++) {
+        int index = node->child[move];
+        if (index < 0) {
+            return move;
+        }
+
+        const MctsNode *child = &worker->nodes[index];
+        float score = child->value / child->visits +
+                      0.7f * sqrtf(logVisits / child->visits);
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+        }
+    }
+    return bestMove;
+}
+
+/* Run one selection / expansion / rollout / backup cycle */
+static void searchOnce(MctsWorker *worker, Game *game) {
+    int path[MCTS_TREE_DEPTH + 1];
+    float reward = 0.0f;
+    int depth = 0;        // Moves played on the game (and in the undo log)
+    int pathLength = 0;   // Tree nodes on the path below the root
+    int node = 0;
+    float foodScore = 0.0f;
+    float discount = 1.0f;
+    bool expanded = false;
+
+    path[0] = 0;
+
+    /* Selection and expansion */
+    while (!game->gameOver && depth < MCTS_TREE_DEPTH) {
+        int move = selectMove(worker, &worker->nodes[node]);
+        int child = worker->nodes[node].child[move];
+        int dir = relativeToDirection(game->snake.direction, move);
+
+        discount *= MCTS_DISCOUNT;
+        if (applyMove(game, dir, &worker->undo[depth++])) {
+            foodScore += discount;
+        }
+
+        if (child < 0) {
+            /* Expand a new leaf if the pool has room, then roll out from it */
+            if (worker->nodeCount < MCTS_MAX_NODES) {
+                child = worker->nodeCount++;
+                worker->nodes[child].child[0] = -1;
+                worker->nodes[child].child[1] = -1;
+                worker->nodes[child].child[2] = -1;
+                worker->nodes[child].visits = 0;
+                worker->nodes[child].value = 0.0f;
+                worker->nodes[node].child[move] = child;
+                path[++pathLength] = child;
+                expanded = true;
+            }
+            break;
+        }
+
+        node = child;
+        path[++pathLength] = node;
+    }
+
+    /* Simulation, unless the threads already know the new leaf well. The
+     * table holds the rollout's score from the leaf on, which other paths
+     * to the same state share; this path's food is added on top. The ply is
+     * part of the key, since the score depends on how soon the food is
+     * eaten. */
+    if (expanded && !game->gameOver) {
+        TransTable *table = &worker->owner->table;
+        uint64_t key = gameHash(game) ^ (uint64_t)depth * 0x9E3779B97F4A7C15ULL;
+        TableEntry entry;
+        bool known = transTableProbe(table, key, &entry, &worker->tableStats);
+        float score;
+
+        if (known && entry.count >= MCTS_TABLE_TRUST) {
+            score = entry.value;
+        } else {
+            score = rollout(worker, game, &depth);
+            if (!known) {
+                entry.value = 0.0f;
+                entry.count = 0;
+            }
+            entry.value = (entry.value * entry.count + score) / (entry.count + 1);
+            entry.count++;
+            entry.depth = MCTS_TREE_DEPTH - pathLength;
+            transTableStore(table, key, &entry, &worker->tableStats);
+        }
+        reward = addPathFood(score, foodScore);
+    } else {
+        reward = addPathFood(rollout(worker, game, &depth), foodScore);
+    }
+
+    /* Backpropagation */
+    for (int i = 0; i <= pathLength; i++) {
+        worker->nodes[path[i]].visits++;
+        worker->nodes[path[i]].value += reward;
+    }
+    worker->rollouts++;
+
+    /* Walk the game back to the root, newest move first */
+    while (depth > 0) {
+        undoMove(game, &worker->undo[--depth]);
+    }
+}
+
+/* Search until the deadline, starting from a fresh tree */
+static void runSearch(MctsWorker *worker, const Game *root,
+                      const struct timespec *deadline) {
+    /* Start from an empty tree first, so a worker that cannot clone the
+     * root adds nothing to the merged statistics */
+    worker->nodeCount = 1;
+    worker->nodes[0].child[0] = -1;
+    worker->nodes[0].child[1] = -1;
+    worker->nodes[0].child[2] = -1;
+    worker->nodes[0].visits = 0;
+    worker->nodes[0].value = 0.0f;
+    worker->rollouts = 0;
+    memset(&worker->tableStats, 0, sizeof(worker->tableStats));
+
+    /* One clone per tick; rollouts play on it and undo their moves */
+    arenaReset(&worker->arena);
+    Game *game = cloneGame(&worker->arena, root, MCTS_ROLLOUT_DEPTH);
+    if (game == NULL) {
+        return;
+    }
+
+    /* Always do a few rollouts, then check the clock every 16 of them */
+    do {
+        for (int i = 0; i < 16; i++) {
+            searchOnce(worker, game);
+        }
+    } while (!pastDeadline(deadline));
+}
+
+/* Helper thread: wait for a search request, run it, report back */
+static void *mctsThread(void *arg) {
+    MctsWorker *worker = arg;
+    MctsController *mcts = worker->owner;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&mcts->lock);
+    for (;;) {
+        while (!mcts->shutdown && mcts->generation == seen) {
+            pthread_cond_wait(&mcts->start, &mcts->lock);
+        }
+        if (mcts->shutdown) {
+            break;
+        }
+        seen = mcts->generation;
+        const Game *root = mcts->root;
+        struct timespec deadline = mcts->deadline;
+        pthread_mutex_unlock(&mcts->lock);
+
+        runSearch(worker, root, &deadline);
+
+        pthread_mutex_lock(&mcts->lock);
+        if (--mcts->running == 0) {
+            pthread_cond_signal(&mcts->done);
+        }
+    }
+    pthread_mutex_unlock(&mcts->lock);
+    return NULL;
+}
+
+/* Create the controller and start its helper threads. The seed picks the
+ * rollouts' random moves; the search is still cut off by the clock, so the
+ * same seed does not always give the same moves. */
+MctsController *createMcts(int threads, int budgetMs, uint64_t seed) {
+    /* Aligned like its workers, which calloc() would not guarantee */
+    void *memory;
+    if (posix_memalign(&memory, 64, sizeof(MctsController)) != 0) {
+        return NULL;
+    }
+    MctsController *mcts = memset(memory, 0, sizeof(MctsController));
+
+    if (threads < 1) threads = 1;
+    if (threads > MCTS_MAX_THREADS) threads = MCTS_MAX_THREADS;
+    mcts->threadCount = threads;
+    mcts->budgetMs = budgetMs;
+    pthread_mutex_init(&mcts->lock, NULL);
+    pthread_cond_init(&mcts->start, NULL);
+    pthread_cond_init(&mcts->done, NULL);
+    if (!transTableInit(&mcts->table, MCTS_TABLE_BYTES)) {
+        mcts->threadCount = 0;
+        destroyMcts(mcts);
+        return NULL;
+    }
+
+    for (int i = 0; i < threads; i++) {
+        MctsWorker *worker = &mcts->workers[i];
+        worker->owner = mcts;
+        worker->rng = 0x9E3779B97F4A7C15ULL * (i + 1) ^ seed;
+        worker->nodes = malloc(MCTS_MAX_NODES * sizeof(MctsNode));
+        if (worker->nodes == NULL ||
+            !arenaInit(&worker->arena, MCTS_ARENA_BYTES)) {
+            mcts->threadCount = i;
+            destroyMcts(mcts);
+            return NULL;
+        }
+    }
+
+    /* Worker 0 is the calling thread; the rest get their own threads */
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&mcts->workers[i].thread, NULL, mctsThread,
+                           &mcts->workers[i]) != 0) {
+            mcts->threadCount = i;
+            break;
+        }
+    }
+
+    return mcts;
+}
+
+/* Search the current position and return the direction to take */
+int mctsChooseMove(MctsController *mcts, const Game *game) {
+    struct timespec deadline;
+    long visits[3] = { 0, 0, 0 };
+    long rollouts = 0;
+    TableStats tableStats = { 0, 0, 0, 0 };
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_nsec += (long)mcts->budgetMs * 1000000L;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+    deadline.tv_nsec %= 1000000000L;
+
+    /* Wake the helper threads */
+    pthread_mutex_lock(&mcts->lock);
+    mcts->root = game;
+    mcts->deadline = deadline;
+    mcts->running = mcts->threadCount - 1;
+    mcts->generation++;
+    transTableNewSearch(&mcts->table);
+    pthread_cond_broadcast(&mcts->start);
+    pthread_mutex_unlock(&mcts->lock);
+
+    /* Search on this thread too, then wait for the others */
+    runSearch(&mcts->workers[0], game, &deadline);
+
+    pthread_mutex_lock(&mcts->lock);
+    while (mcts->running > 0) {
+        pthread_cond_wait(&mcts->done, &mcts->lock);
+    }
+    pthread_mutex_unlock(&mcts->lock);
+
+    /* Merge the root statistics of every tree */
+    for (int i = 0; i < mcts->threadCount; i++) {
+        const MctsWorker *worker = &mcts->workers[i];
+        for (int move = 0; move < 3; move++) {
+            int child = worker->nodes[0].child[move];
+            if (child >= 0) {
+                visits[move] += worker->nodes[child].visits;
+            }
+        }
+        rollouts += worker->rollouts;
+        tableStats.probes += worker->tableStats.probes;
+        tableStats.hits += worker->tableStats.hits;
+        tableStats.stores += worker->tableStats.stores;
+        tableStats.evictions += worker->tableStats.evictions;
+    }
+    mcts->lastRollouts = rollouts;
+    mcts->lastTableStats = tableStats;
+
+    int bestMove = 1;
+    for (int move = 0; move < 3; move++) {
+        if (visits[move] > visits[bestMove]) {
+            bestMove = move;
+        }
+    }
+    return relativeToDirection(game->snake.direction, bestMove);
+}
+
+/* Number of rollouts performed by the most recent search */
+long mctsLastRollouts(const MctsController *mcts) {
+    return mcts->lastRollouts;
+}
+
+/* Transposition table counters of the most recent search, over all threads */
+void mctsLastTableStats(const MctsController *mcts, TableStats *stats) {
+    *stats = mcts->lastTableStats;
+}
+
+/* Stop the helper threads and free everything */
+void destroyMcts(MctsController *mcts) {
+    if (mcts == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&mcts->lock);
+    mcts->shutdown = true;
+    pthread_cond_broadcast(&mcts->start);
+    pthread_mutex_unlock(&mcts->lock);
+
+    for (int i = 1; i < mcts->threadCount; i++) {
+        pthread_join(mcts->workers[i].thread, NULL);
+    }
+    for (int i = 0; i < MCTS_MAX_THREADS; i++) {
+        free(mcts->workers[i].nodes);
+        arenaFree(&mcts->workers[i].arena);
+    }
+    transTableFree(&mcts->table);
+
+    pthread_cond_destroy(&mcts->start);
+    pthread_cond_destroy(&mcts->done);
+    pthread_mutex_destroy(&mcts->lock);
+    free(mcts);
+}
+
+/* Hand-tuned weights used when no trained weights are loaded */
+void defaultHeuristicWeights(HeuristicWeights *weights) {
+    weights->weight[FEATURE_FOOD] = -1.0f;
+    weights->weight[FEATURE_AREA] = 2.0f;
+    weights->weight[FEATURE_TAIL] = -0.2f;
+    weights->weight[FEATURE_TRAP] = -3.0f;
+    weights->weight[FEATURE_STRAIGHT] = 0.05f;
+}
+
+/* Read weights from the "best" line of a snake-train checkpoint file */
+bool loadHeuristicWeights(const char *path, HeuristicWeights *weights) {
+    char line[512];
+    bool found = false;
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    while (!found && fgets(line, sizeof(line), file) != NULL) {
+        char *cursor = line;
+        if (strncmp(cursor, "best ", 5) != 0) {
+            continue;
+        }
+        cursor += 5;
+
+        found = true;
+        for (int i = 0; i < HEURISTIC_FEATURES; i++) {
+            char *end;
+            weights->weight[i] = strtof(cursor, &end);
+            if (end == cursor) {
+                found = false;
+                break;
+            }
+            cursor = end;
+        }
+    }
+
+    fclose(file);
+    return found;
+}
+
+/* Score the three moves with the weighted features and return the best */
+int heuristicChooseMove(const Game *game, const HeuristicWeights *weights) {
+    const Snake *snake = &game->snake;
+    Point tail = snakeSegment(snake, snake->size - 1);
+    int freeCells = PLAY_CELLS - snake->size + 1;
+    float span = (float)(WIDTH + HEIGHT - 4) / 2.0f;
+    int bestDir = snake->direction;
+    float bestScore = -1e30f;
+
+    for (int move = 0; move < 3; move++) {
+        int dir = relativeToDirection(snake->direction, move);
+        Point next = nextHead(snake, dir);
+        float feature[HEURISTIC_FEATURES];
+        float score = 0.0f;
+
+        /* Moving into the body loses outright */
+        if (!cellSafeAt(snake, next, 1)) {
+            continue;
+        }
+
+        int area = reachableArea(snake, next, tail);
+        feature[FEATURE_FOOD] = wrapDistance(next, game->food) / span;
+        feature[FEATURE_AREA] = (float)area / (freeCells > 0 ? freeCells : 1);
+        feature[FEATURE_TAIL] = wrapDistance(next, tail) / span;
+        feature[FEATURE_TRAP] = area < snake->size ? 1.0f : 0.0f;
+        feature[FEATURE_STRAIGHT] = dir == snake->direction ? 1.0f : 0.0f;
+
+        for (int i = 0; i < HEURISTIC_FEATURES; i++) {
+            score += weights->weight[i] * feature[i];
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            bestDir = dir;
+        }
+    }
+
+    return bestDir;
+}
@@ -0,0 +1,46 @@
+/**
+ * Snake Game - AI Controllers
+ *
+ * Controllers look at a Game and pick the direction for the next tick.
+ * They never modify the game they are given; any lookahead runs on copies.
+ */
+
+#ifndef AI_H
+#define AI_H
+
+#include "game.h"
+#include "ttable.h"
+
+/* Monte Carlo tree search settings */
+#define MCTS_MAX_THREADS   64     // Upper limit on search threads
+#define MCTS_MAX_NODES     65536  // Tree nodes per thread
+#define MCTS_TREE_DEPTH    24     // Deepest move sequence kept in the tree
+#define MCTS_ROLLOUT_DEPTH 64     // Ticks simulated per rollout
+
+/* Heuristic controller features, each computed for the cell a move leads to */
+#define FEATURE_FOOD     0  // Wrap-around distance to the food
+#define FEATURE_AREA     1  // Share of the free cells still reachable
+#define FEATURE_TAIL     2  // Distance to the tail (following it is safe)
+#define FEATURE_TRAP     3  // 1 if fewer cells are reachable than the body has
+#define FEATURE_STRAIGHT 4  // 1 if the move keeps the current heading
+#define HEURISTIC_FEATURES 5
+
+/* Weights for the heuristic controller (a move's score is the weighted sum) */
+typedef struct {
+    float weight[HEURISTIC_FEATURES];
+} HeuristicWeights;
+
+/* Opaque handle for the MCTS controller and its worker threads */
+typedef struct MctsController MctsController;
+
+/* Function prototypes */
+MctsController *createMcts(int threads, int budgetMs, uint64_t seed);
+int mctsChooseMove(MctsController *mcts, const Game *game);
+long mctsLastRollouts(const MctsController *mcts);
+void mctsLastTableStats(const MctsController *mcts, TableStats *stats);
+void destroyMcts(MctsController *mcts);
+void defaultHeuristicWeights(HeuristicWeights *weights);
+bool loadHeuristicWeights(const char *path, HeuristicWeights *weights);
+int heuristicChooseMove(const Game *game, const HeuristicWeights *weights);
+
+#endif /* AI_H */
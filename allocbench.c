@@ -0,0 +1,299 @@
+/**
+ * Snake Game - Steady-State Allocation Check (snake-allocbench)
+ *
+ * Runs the hot loops of the game - every bot's ticks, the MCTS search, the
+ * batched policy, undo-based search and food placement - in a build whose
+ * allocator calls are counted (see allocwatch.h), and fails if any of them
+ * allocates once it has warmed up. Everything a tick needs must come from
+ * startup allocations or an arena.
+ *
+ * Allocations made while setting up a game (creating a bot's per-game
+ * state) are listed separately and do not fail the check.
+ *
+ * Build and run with: make alloc-check
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "game.h"
+#include "ai.h"
+#include "policy.h"
+#include "bots.h"
+#include "allocwatch.h"
+
+#define WARMUP_TICKS 200   // Ticks per phase before counting starts
+#define SEARCH_DEPTH 32    // Moves per search line in the undo phase
+
+/* Results of one phase */
+typedef struct {
+    char name[32];
+    long long ticks;         // Ticks counted
+    long long allocations;   // Allocations during those ticks
+    long long setup;         // Allocations while setting up games
+} Phase;
+
+/* A bot being counted by benchBot() */
+typedef struct {
+    Phase *phase;
+    long long played;        // Ticks played over all games
+    long long target;        // Ticks to play, warm-up included
+    long long mark;          // allocationCount() when the last tick ended
+} BotBench;
+
+/* Function prototypes */
+void benchBot(const BotType *type, long long ticks, Arena *arena, Phase *phase);
+bool countBotTick(void *context, const Game *game, int tick, bool ate);
+void benchMcts(int budgetMs, long long ticks, Arena *arena, Phase *phase);
+void benchPolicy(long long ticks, Phase *phase);
+void benchSearch(long long ticks, Arena *arena, Phase *phase);
+void benchPlacement(long long ticks, Arena *arena, Phase *phase);
+void usage(const char *program);
+
+/* Main function - entry point of the program */
+int main(int argc, char *argv[]) {
+    BotOptions botOptions = { NULL, NULL, 1, NULL, 10000, NULL, 1, NULL };
+    Phase phases[16];
+    int phaseCount = 0;
+    long long ticks = 20000;
+    int mctsBudgetMs = 1;
+    Arena arena;
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--mcts-ms") == 0 && i + 1 < argc) {
+            mctsBudgetMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--weights") == 0 && i + 1 < argc) {
+            botOptions.weightsFile = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    /* Startup: everything allocated here may stay for the whole run */
+    char error[256];
+    if (!configureBots(&botOptions, error, sizeof(error))) {
+        fprintf(stderr, "%s\n", error);
+        return 1;
+    }
+    if (!arenaInit(&arena, GAME_ARENA_BYTES)) {
+        fprintf(stderr, "Startup failed\n");
+        return 1;
+    }
+    printf("Counting allocations after %d warm-up ticks per phase\n\n", WARMUP_TICKS);
+
+    /* Every cheap bot; MCTS and the policy get phases of their own */
+    for (int i = 0; i < botCount(); i++) {
+        const BotType *type = botAt(i);
+        if (botAvailable(type) && type->cost < 100) {
+            benchBot(type, ticks, &arena, &phases[phaseCount++]);
+        }
+    }
+    benchMcts(mctsBudgetMs, ticks / 100 + 1, &arena, &phases[phaseCount++]);
+    benchPolicy(ticks, &phases[phaseCount++]);
+    benchSearch(ticks, &arena, &phases[phaseCount++]);
+    benchPlacement(ticks, &arena, &phases[phaseCount++]);
+
+    /* Report */
+    bool clean = true;
+    printf("%-16s %10s %12s %12s\n", "phase", "ticks", "allocations", "game setup");
+    for (int i = 0; i < phaseCount; i++) {
+        printf("%-16s %10lld %12lld %12lld\n", phases[i].name, phases[i].ticks,
+               phases[i].allocations, phases[i].setup);
+        if (phases[i].allocations != 0) {
+            clean = false;
+        }
+    }
+
+    arenaFree(&arena);
+    if (!clean) {
+        printf("\nFAILED: the steady state allocates\n");
+        return 1;
+    }
+    printf("\nNo allocations in the steady state\n");
+    return 0;
+}
+
+/* Play games with a bot; only the ticks after the warm-up are counted */
+void benchBot(const BotType *type, long long ticks, Arena *arena, Phase *phase) {
+    BotBench bench = { phase, 0, ticks + WARMUP_TICKS, 0 };
+    PlayOptions options = { 0, false, countBotTick, &bench };
+
+    memset(phase, 0, sizeof(Phase));
+    snprintf(phase->name, sizeof(phase->name), "bot %s", type->name);
+
+    while (bench.played < bench.target) {
+        bench.mark = allocationCount();
+        void *state = type->create != NULL ? type->create(bench.played + 1) : NULL;
+        Game game;
+        playBotGame(&game, arena, (uint64_t)bench.played + 1, type->chooseMove, state,
+                    &options);
+
+        long long before = allocationCount();
+        if (type->destroy != NULL) {
+            type->destroy(state);
+        }
+        phase->setup += allocationCount() - before;
+    }
+}
+
+/* Count the allocations of one tick of benchBot(): setting the game up is
+ * tick 0, and every move after the warm-up counts against the bot */
+bool countBotTick(void *context, const Game *game, int tick, bool ate) {
+    BotBench *bench = context;
+    long long now = allocationCount();
+
+    (void)game;
+    (void)ate;
+    if (tick == 0) {
+        bench->phase->setup += now - bench->mark;
+    } else {
+        if (bench->played >= WARMUP_TICKS) {
+            bench->phase->allocations += now - bench->mark;
+            bench->phase->ticks++;
+        }
+        bench->played++;
+    }
+    bench->mark = now;
+    return bench->played < bench->target;
+}
+
+/* MCTS ticks: the thread pool and the per-thread arenas exist beforehand */
+void benchMcts(int budgetMs, long long ticks, Arena *arena, Phase *phase) {
+    long long before = allocationCount();
+    MctsController *mcts = createMcts(2, budgetMs, 1);
+    Game game;
+
+    memset(phase, 0, sizeof(Phase));
+    snprintf(phase->name, sizeof(phase->name), "mcts");
+    arenaReset(arena);
+    initializeGame(&game, arena, 1);
+    phase->setup = allocationCount() - before;
+    if (mcts == NULL) {
+        return;
+    }
+
+    for (long long played = 0; played < ticks + WARMUP_TICKS / 10; played++) {
+        if (game.gameOver) {
+            arenaReset(arena);
+            initializeGame(&game, arena, (uint64_t)played + 1);
+        }
+        before = allocationCount();
+        turnSnake(&game.snake, mctsChooseMove(mcts, &game));
+        stepGame(&game);
+        if (played >= WARMUP_TICKS / 10) {
+            phase->allocations += allocationCount() - before;
+            phase->ticks++;
+        }
+    }
+
+    before = allocationCount();
+    destroyMcts(mcts);
+    phase->setup += allocationCount() - before;
+}
+
+/* Batched policy decisions over a full batch of games that restart in place */
+void benchPolicy(long long ticks, Phase *phase) {
+    static Arena arenas[POLICY_MAX_BATCH];
+    static Game games[POLICY_MAX_BATCH];
+    const Game *live[POLICY_MAX_BATCH];
+    int directions[POLICY_MAX_BATCH];
+    long long before = allocationCount();
+    Policy policy;
+
+    memset(phase, 0, sizeof(Phase));
+    snprintf(phase->name, sizeof(phase->name), "policy batch");
+    if (!randomPolicy(&policy, 1)) {
+        return;
+    }
+    for (int g = 0; g < POLICY_MAX_BATCH; g++) {
+        if (!arenaInit(&arenas[g], GAME_ARENA_BYTES)) {
+            return;
+        }
+        initializeGame(&games[g], &arenas[g], (uint64_t)g + 1);
+        live[g] = &games[g];
+    }
+    phase->setup = allocationCount() - before;
+
+    uint64_t seed = POLICY_MAX_BATCH + 1;
+    for (long long played = 0; played < ticks + WARMUP_TICKS; played += POLICY_MAX_BATCH) {
+        before = allocationCount();
+        policyChooseMoves(&policy, live, POLICY_MAX_BATCH, directions);
+        for (int g = 0; g < POLICY_MAX_BATCH; g++) {
+            turnSnake(&games[g].snake, directions[g]);
+            stepGame(&games[g]);
+            if (games[g].gameOver) {
+                arenaReset(&arenas[g]);
+                initializeGame(&games[g], &arenas[g], seed++);
+            }
+        }
+        if (played >= WARMUP_TICKS) {
+            phase->allocations += allocationCount() - before;
+            phase->ticks += POLICY_MAX_BATCH;
+        }
+    }
+
+    freePolicy(&policy);
+    for (int g = 0; g < POLICY_MAX_BATCH; g++) {
+        arenaFree(&arenas[g]);
+    }
+}
+
+/* Random search lines walked forwards with applyMove() and back with undoMove() */
+void benchSearch(long long ticks, Arena *arena, Phase *phase) {
+    MoveUndo undo[SEARCH_DEPTH];
+    uint64_t rng = 7;
+    Game game;
+
+    memset(phase, 0, sizeof(Phase));
+    snprintf(phase->name, sizeof(phase->name), "undo search");
+    arenaReset(arena);
+    initializeGame(&game, arena, 3);
+
+    for (long long played = 0; played < ticks + WARMUP_TICKS; played += SEARCH_DEPTH) {
+        long long before = allocationCount();
+        int depth = 0;
+        while (depth < SEARCH_DEPTH && !game.gameOver) {
+            applyMove(&game, (int)(gameRandom(&rng) & 3), &undo[depth++]);
+        }
+        while (depth > 0) {
+            undoMove(&game, &undo[--depth]);
+        }
+        if (played >= WARMUP_TICKS) {
+            phase->allocations += allocationCount() - before;
+            phase->ticks += SEARCH_DEPTH;
+        }
+    }
+}
+
+/* Food placement on a board with a long snake */
+void benchPlacement(long long ticks, Arena *arena, Phase *phase) {
+    Game game;
+
+    memset(phase, 0, sizeof(Phase));
+    snprintf(phase->name, sizeof(phase->name), "placeFood");
+    arenaReset(arena);
+    initializeGame(&game, arena, 5);
+
+    for (long long played = 0; played < ticks + WARMUP_TICKS; played++) {
+        long long before = allocationCount();
+        placeFood(&game);
+        if (played >= WARMUP_TICKS) {
+            phase->allocations += allocationCount() - before;
+            phase->ticks++;
+        }
+    }
+}
+
+/* Print command line help */
+void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --ticks N         Ticks counted per phase (default 20000)\n");
+    fprintf(stderr, "  --mcts-ms N       MCTS thinking time per tick (default 1)\n");
+    fprintf(stderr, "  --weights FILE    Heuristic bot weights\n");
+}
@@ -0,0 +1,53 @@
+/**
+ * Snake Game - Allocation Counter
+ *
+ * See allocwatch.h. Every wrapper bumps one shared counter and then calls
+ * the real allocator. The counter is atomic, which is fine here: the point
+ * of the check is that it is never touched while the game is running.
+ */
+
+#include <stddef.h>
+#include "allocwatch.h"
+
+static long long allocations = 0;
+
+/* The real allocator, under the names the linker gives it with --wrap */
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+int __real_posix_memalign(void **pointer, size_t alignment, size_t size);
+
+/* Wrappers the linker substitutes for the allocator */
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t count, size_t size);
+void *__wrap_realloc(void *pointer, size_t size);
+int __wrap_posix_memalign(void **pointer, size_t alignment, size_t size);
+
+static void countAllocation(void) {
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+}
+
+void *__wrap_malloc(size_t size) {
+    countAllocation();
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    countAllocation();
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    countAllocation();
+    return __real_realloc(pointer, size);
+}
+
+int __wrap_posix_memalign(void **pointer, size_t alignment, size_t size) {
+    countAllocation();
+    return __real_posix_memalign(pointer, alignment, size);
+}
+
+/* Allocations made so far by all threads */
+long long allocationCount(void) {
+    return __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+}
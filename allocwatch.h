@@ -0,0 +1,17 @@
+/**
+ * Snake Game - Allocation Counter
+ *
+ * Counts calls to the heap allocator, for the instrumented build that checks
+ * the game loop never allocates (make alloc-check). allocwatch.c defines
+ * wrappers that the linker puts in place of malloc() and friends when given
+ * -Wl,--wrap=malloc and so on; see ALLOC_WRAP in the Makefile. Only calls
+ * made from the game's own code are counted, not those inside the C library.
+ */
+
+#ifndef ALLOCWATCH_H
+#define ALLOCWATCH_H
+
+/* Function prototypes */
+long long allocationCount(void);
+
+#endif /* ALLOCWATCH_H */
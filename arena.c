@@ -0,0 +1,59 @@
+/**
+ * Snake Game - Arena Allocator
+ *
+ * See arena.h. The only malloc happens in arenaInit(); after that, memory is
+ * reused by rewinding to a mark (after each simulation) or by a full reset
+ * (once per tick).
+ */
+
+#include <stdlib.h>
+#include "arena.h"
+
+/* Allocate the backing block for an arena */
+bool arenaInit(Arena *arena, size_t size) {
+    arena->base = malloc(size);
+    arena->size = arena->base != NULL ? size : 0;
+    arena->used = 0;
+    arena->peak = 0;
+    return arena->base != NULL;
+}
+
+/* Hand out 'bytes' bytes, or NULL if the arena is full */
+void *arenaAlloc(Arena *arena, size_t bytes) {
+    size_t start = (arena->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    if (start > arena->size || bytes > arena->size - start) {
+        return NULL;
+    }
+
+    arena->used = start + bytes;
+    if (arena->used > arena->peak) {
+        arena->peak = arena->used;
+    }
+    return arena->base + start;
+}
+
+/* Remember the current position so later allocations can be undone */
+size_t arenaMark(const Arena *arena) {
+    return arena->used;
+}
+
+/* Free everything allocated since arenaMark() returned 'mark' */
+void arenaRelease(Arena *arena, size_t mark) {
+    if (mark < arena->used) {
+        arena->used = mark;
+    }
+}
+
+/* Free everything in the arena at once */
+void arenaReset(Arena *arena) {
+    arena->used = 0;
+}
+
+/* Give the backing block back to the system */
+void arenaFree(Arena *arena) {
+    free(arena->base);
+    arena->base = NULL;
+    arena->size = 0;
+    arena->used = 0;
+}
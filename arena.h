@@ -0,0 +1,33 @@
+/**
+ * Snake Game - Arena Allocator
+ *
+ * An arena is one block of memory handed out front to back. Allocating is
+ * just moving a pointer, and everything is freed at once by resetting it.
+ * Simulations use arenas to clone game states without calling malloc.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ARENA_ALIGN 16  // Every allocation starts on a 16-byte boundary
+
+/* Structure to represent an arena */
+typedef struct {
+    unsigned char *base;  // Start of the block (allocated once)
+    size_t size;          // Total bytes in the block
+    size_t used;          // Bytes handed out so far
+    size_t peak;          // Highest value 'used' has reached
+} Arena;
+
+/* Function prototypes */
+bool arenaInit(Arena *arena, size_t size);
+void *arenaAlloc(Arena *arena, size_t bytes);
+size_t arenaMark(const Arena *arena);
+void arenaRelease(Arena *arena, size_t mark);
+void arenaReset(Arena *arena);
+void arenaFree(Arena *arena);
+
+#endif /* ARENA_H */
@@ -0,0 +1,327 @@
+/**
+ * Snake Game - Bot Registry
+ *
+ * Wrappers that turn each controller in ai.c and policy.c into a BotType.
+ * Shared read-only data (heuristic weights, network weights) is loaded once
+ * by configureBots(); per-instance state holds only what a single game needs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bots.h"
+#include "ai.h"
+#include "distfield.h"
+#include "policy.h"
+#include "plugin.h"
+#include "solver.h"
+
+/* Shared data loaded by configureBots() */
+static HeuristicWeights heuristicWeights;
+static Policy policy;
+static bool policyLoaded = false;
+static int mctsBudgetMs = 5;
+static const char *pluginFile = NULL;
+static long pluginBudgetUs = 10000;
+static const char *pluginArgs = NULL;
+static int mctsThreads = 1;
+static SolvedTable solvedTable;
+static bool solvedLoaded = false;
+
+/* Moves that do not run straight into the body (the tail is moving away,
+ * unless it has just grown) */
+static int safeMoves(const Game *game, int *directions) {
+    const Snake *snake = &game->snake;
+    int count = 0;
+
+    for (int move = 0; move < 3; move++) {
+        int dir = (snake->direction + 3 + move) % 4;
+        Point next = nextHead(snake, dir);
+        if (cellSafeAt(snake, next, 1)) {
+            directions[count++] = dir;
+        }
+    }
+    return count;
+}
+
+/* Greedy bot: the safe move with the shortest path to the food. The
+ * distance field is kept up to date tick by tick, so choosing is one lookup
+ * per move; when the food is cut off, the bot heads for it in a straight
+ * line instead. */
+static void *greedyCreate(uint64_t seed) {
+    (void)seed;
+    return calloc(1, sizeof(DistanceField));
+}
+
+static void greedyNewGame(void *state) {
+    DistanceField *field = state;
+    if (field != NULL) {
+        field->valid = false;
+    }
+}
+
+static int greedyMove(void *state, const Game *game) {
+    DistanceField *field = state;
+    int directions[3];
+    int count = safeMoves(game, directions);
+    int best = game->snake.direction;
+    int bestDistance = 2 * DISTANCE_NONE;
+
+    if (field != NULL) {
+        updateDistanceField(field, game);
+    }
+    for (int i = 0; i < count; i++) {
+        Point next = nextHead(&game->snake, directions[i]);
+        int distance = field != NULL ? distanceToFood(field, next) : DISTANCE_NONE;
+        if (distance == DISTANCE_NONE) {
+            int dx = abs(next.x - game->food.x);
+            int dy = abs(next.y - game->food.y);
+            if (dx > WIDTH - 2 - dx) dx = WIDTH - 2 - dx;
+            if (dy > HEIGHT - 2 - dy) dy = HEIGHT - 2 - dy;
+            distance = DISTANCE_NONE + dx + dy;
+        }
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = directions[i];
+        }
+    }
+    return best;
+}
+
+/* Random bot: any safe move, from its own seeded generator */
+static void *randomCreate(uint64_t seed) {
+    uint64_t *rng = malloc(sizeof(uint64_t));
+    if (rng != NULL) {
+        *rng = seed ? seed : 1;
+    }
+    return rng;
+}
+
+static int randomMove(void *state, const Game *game) {
+    int directions[3];
+    int count = safeMoves(game, directions);
+    if (count == 0) {
+        return game->snake.direction;
+    }
+    return directions[gameRandom(state) % count];
+}
+
+/* Heuristic bot */
+static int heuristicMove(void *state, const Game *game) {
+    (void)state;
+    return heuristicChooseMove(game, &heuristicWeights);
+}
+
+/* Neural network policy bot */
+static int policyMove(void *state, const Game *game) {
+    (void)state;
+    return policyChooseMove(&policy, game);
+}
+
+/* Solved bot: perfect play looked up in a table from snake-solve (only
+ * for the tiny board the table was solved on) */
+static int solvedMove(void *state, const Game *game) {
+    (void)state;
+    return solvedChooseMove(&solvedTable, game);
+}
+
+/* MCTS bot: a search per instance (single-threaded unless configured
+ * otherwise), seeded by the match */
+static void *mctsCreate(uint64_t seed) {
+    return createMcts(mctsThreads, mctsBudgetMs, seed);
+}
+
+static int mctsMove(void *state, const Game *game) {
+    return mctsChooseMove(state, game);
+}
+
+static void mctsDestroy(void *state) {
+    destroyMcts(state);
+}
+
+static void mctsStatus(void *state, char *text, size_t size) {
+    TableStats tableStats;
+    mctsLastTableStats(state, &tableStats);
+    snprintf(text, size, "AI: %ld rollouts, table hits %.0f%%", mctsLastRollouts(state),
+             tableStats.probes > 0 ? 100.0 * tableStats.hits / tableStats.probes : 0.0);
+}
+
+/* Plugin bot: every instance opens the library and counts its own ticks */
+typedef struct {
+    PluginBot bot;
+    uint64_t tick;
+} PluginInstance;
+
+static void *pluginCreate(uint64_t seed) {
+    char error[256];
+    char args[32];
+    PluginInstance *instance = calloc(1, sizeof(PluginInstance));
+
+    if (instance == NULL) {
+        return NULL;
+    }
+    /* Unless told otherwise, the plugin gets the game seed, so random bots
+     * can be reproducible */
+    snprintf(args, sizeof(args), "%llu", (unsigned long long)seed);
+    if (!loadPluginBot(&instance->bot, pluginFile, pluginArgs != NULL ? pluginArgs : args,
+                       pluginBudgetUs * 1000, error, sizeof(error))) {
+        fprintf(stderr, "Could not load plugin: %s\n", error);
+        free(instance);
+        return NULL;
+    }
+    return instance;
+}
+
+static int pluginMove(void *state, const Game *game) {
+    PluginInstance *instance = state;
+    if (instance == NULL) {
+        return game->snake.direction;
+    }
+    return pluginChooseMove(&instance->bot, game, instance->tick++);
+}
+
+static void pluginNewGame(void *state) {
+    PluginInstance *instance = state;
+    if (instance != NULL) {
+        instance->tick = 0;
+    }
+}
+
+static void pluginStatus(void *state, char *text, size_t size) {
+    PluginInstance *instance = state;
+    if (instance == NULL) {
+        snprintf(text, size, "Bot not loaded");
+        return;
+    }
+    formatPluginStats(&instance->bot, text, size);
+}
+
+static void pluginDestroy(void *state) {
+    PluginInstance *instance = state;
+    if (instance != NULL) {
+        unloadPluginBot(&instance->bot);
+        free(instance);
+    }
+}
+
+/* Every registered bot */
+static const BotType BOTS[] = {
+    { "greedy", "Safe move with the shortest path to the food", 1, greedyCreate,
+      greedyMove, free, greedyNewGame, NULL },
+    { "random", "Random safe move", 1, randomCreate, randomMove, free, NULL, NULL },
+    { "heuristic", "Weighted features (see snake-train)", 4, NULL, heuristicMove, NULL,
+      NULL, NULL },
+    { "policy", "Neural network policy (needs a policy file)", 2, NULL, policyMove, NULL,
+      NULL, NULL },
+    { "mcts", "Monte Carlo tree search (time limited)", 1000, mctsCreate, mctsMove,
+      mctsDestroy, NULL, mctsStatus },
+    { "plugin", "Bot from a shared library (needs a plugin file)", 2, pluginCreate,
+      pluginMove, pluginDestroy, pluginNewGame, pluginStatus },
+    { "solved", "Perfect play from a solved table (tiny boards only)", 1, NULL, solvedMove,
+      NULL, NULL, NULL },
+};
+
+#define BOT_TYPES ((int)(sizeof(BOTS) / sizeof(BOTS[0])))
+
+/* Load the shared data the bots need; on failure 'error' says what went
+ * wrong */
+bool configureBots(const BotOptions *options, char *error, size_t errorSize) {
+    defaultHeuristicWeights(&heuristicWeights);
+    if (options->weightsFile != NULL &&
+        !loadHeuristicWeights(options->weightsFile, &heuristicWeights)) {
+        snprintf(error, errorSize, "Could not read heuristic weights from %s",
+                 options->weightsFile);
+        return false;
+    }
+    if (options->policyFile != NULL) {
+        if (!loadPolicy(&policy, options->policyFile)) {
+            snprintf(error, errorSize, "Could not load a policy network from %s",
+                     options->policyFile);
+            return false;
+        }
+        policyLoaded = true;
+    }
+    if (options->mctsBudgetMs > 0) {
+        mctsBudgetMs = options->mctsBudgetMs;
+    }
+    if (options->mctsThreads > 0) {
+        mctsThreads = options->mctsThreads;
+    }
+    pluginFile = options->pluginFile;
+    pluginArgs = options->pluginArgs;
+    if (options->pluginBudgetUs > 0) {
+        pluginBudgetUs = options->pluginBudgetUs;
+    }
+    if (options->solvedFile != NULL) {
+        if (!loadSolvedTable(&solvedTable, options->solvedFile, error, errorSize)) {
+            return false;
+        }
+        solvedLoaded = true;
+    }
+    return true;
+}
+
+/* Number of registered bots */
+int botCount(void) {
+    return BOT_TYPES;
+}
+
+/* Bot by position in the registry */
+const BotType *botAt(int index) {
+    return index >= 0 && index < BOT_TYPES ? &BOTS[index] : NULL;
+}
+
+/* Bot by name, or NULL */
+const BotType *findBot(const char *name) {
+    for (int i = 0; i < BOT_TYPES; i++) {
+        if (strcmp(BOTS[i].name, name) == 0) {
+            return &BOTS[i];
+        }
+    }
+    return NULL;
+}
+
+/* False for bots whose data has not been loaded */
+bool botAvailable(const BotType *type) {
+    if (type->chooseMove == policyMove) {
+        return policyLoaded;
+    }
+    if (type->chooseMove == pluginMove) {
+        return pluginFile != NULL;
+    }
+    if (type->chooseMove == solvedMove) {
+        return solvedLoaded;
+    }
+    return true;
+}
+
+/* Play one game from 'seed' in the arena (reset first), asking chooseMove()
+ * for every move. The game ends on a bite, a full board, STALL_TICKS without
+ * food, maxTicks or the hook; returns the ticks played. */
+int playBotGame(Game *game, Arena *arena, uint64_t seed,
+                int (*chooseMove)(void *state, const Game *game), void *state,
+                const PlayOptions *options) {
+    int tick = 0;
+    int lastMeal = 0;
+
+    arenaReset(arena);
+    initializeGame(game, arena, seed);
+    game->stats.measureArea = options->measureArea;
+    if (options->onTick != NULL && !options->onTick(options->context, game, 0, false)) {
+        return 0;
+    }
+
+    while (!game->gameOver && (options->maxTicks <= 0 || tick < options->maxTicks) &&
+           tick - lastMeal < STALL_TICKS) {
+        turnSnake(&game->snake, chooseMove(state, game));
+        bool ate = stepGame(game);
+        if (ate) {
+            lastMeal = tick;
+        }
+        tick++;
+        if (options->onTick != NULL && !options->onTick(options->context, game, tick, ate)) {
+            break;
+        }
+    }
+    return tick;
+}
@@ -0,0 +1,64 @@
+/**
+ * Snake Game - Bot Registry
+ *
+ * Gives every AI controller the same shape, so tools such as the tournament
+ * runner can create, run and compare them by name.
+ */
+
+#ifndef BOTS_H
+#define BOTS_H
+
+#include "game.h"
+
+/* A game that goes this long without eating is stuck in a loop */
+#define STALL_TICKS (PLAY_CELLS * 2)
+
+/* One kind of bot. Each thread creates its own instance with create(), so
+ * instances never need locking. An instance can play one game after another
+ * if newGame() is called in between. */
+typedef struct {
+    const char *name;
+    const char *description;
+    int cost;                                   // Rough time per move, relative
+    void *(*create)(uint64_t seed);             // NULL state is allowed
+    int (*chooseMove)(void *state, const Game *game);
+    void (*destroy)(void *state);
+    void (*newGame)(void *state);               // Forget the last game (NULL: nothing kept)
+    void (*status)(void *state, char *text, size_t size);  // Status bar text (NULL: none)
+} BotType;
+
+/* Settings that some bots need */
+typedef struct {
+    const char *weightsFile;   // Heuristic weights (NULL for the defaults)
+    const char *policyFile;    // Network weights (the policy bot needs this)
+    int mctsBudgetMs;          // Thinking time per move for the MCTS bot
+    const char *pluginFile;    // Shared library for the plugin bot
+    long pluginBudgetUs;       // Time per move for the plugin bot
+    const char *solvedFile;    // Policy table for the solved bot (see snake-solve)
+    int mctsThreads;           // Search threads per MCTS instance
+    const char *pluginArgs;    // String for the plugin's create() (NULL: the game seed)
+} BotOptions;
+
+/* Called by playBotGame() once the game is set up (tick 0) and after every
+ * tick; returning false ends the game there */
+typedef bool (*TickHook)(void *context, const Game *game, int tick, bool ate);
+
+/* How playBotGame() plays a game */
+typedef struct {
+    int maxTicks;              // Most ticks to play (0 for no limit)
+    bool measureArea;          // Track the area dip (see GameStats)
+    TickHook onTick;           // NULL for none
+    void *context;             // Passed to onTick
+} PlayOptions;
+
+/* Function prototypes */
+bool configureBots(const BotOptions *options, char *error, size_t errorSize);
+int botCount(void);
+const BotType *botAt(int index);
+const BotType *findBot(const char *name);
+bool botAvailable(const BotType *type);
+int playBotGame(Game *game, Arena *arena, uint64_t seed,
+                int (*chooseMove)(void *state, const Game *game), void *state,
+                const PlayOptions *options);
+
+#endif /* BOTS_H */
@@ -0,0 +1,26 @@
+/**
+ * Snake Game - Monotonic Clock
+ *
+ * Every tool times its runs, budgets and deadlines with the monotonic
+ * clock, which does not jump when the wall clock is set. The file that
+ * includes this must define _POSIX_C_SOURCE first, for clock_gettime().
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <time.h>
+
+/* Monotonic clock in nanoseconds */
+static inline long long nowNs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/* Monotonic clock in seconds */
+static inline double secondsNow(void) {
+    return nowNs() / 1e9;
+}
+
+#endif /* CLOCK_H */
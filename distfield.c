@@ -0,0 +1,214 @@
+/**
+ * Snake Game - Distance Field to the Food
+ *
+ * See distfield.h. The body's occupancy grid is the map of walls, so the
+ * field always agrees with the snake it was last updated with.
+ */
+
+#include <stdlib.h>
+#include "distfield.h"
+
+/* Helpers for the bitmap of cells being repaired */
+static bool isAffected(const DistanceField *field, int cell) {
+    return (field->affected[cell >> 6] >> (cell & 63)) & 1;
+}
+
+static void setAffected(DistanceField *field, int cell, bool on) {
+    if (on) {
+        field->affected[cell >> 6] |= 1ULL << (cell & 63);
+    } else {
+        field->affected[cell >> 6] &= ~(1ULL << (cell & 63));
+    }
+}
+
+/* Cell index of a neighbour (the board wraps) */
+static int neighbour(int cell, int direction) {
+    Point p = { cell % WIDTH, cell / WIDTH };
+    return cellIndex(movePoint(p, direction));
+}
+
+/* True if the body does not cover the cell */
+static bool isOpen(const Snake *snake, int cell) {
+    return !((snake->occupied[cell >> 6] >> (cell & 63)) & 1);
+}
+
+/* Remember the snake the field now matches */
+static void noteSnake(DistanceField *field, const Game *game) {
+    field->food = game->food;
+    field->head = snakeSegment(&game->snake, 0);
+    field->tail = snakeSegment(&game->snake, game->snake.size - 1);
+    field->moves = game->snake.moves;
+    field->valid = true;
+}
+
+/* Breadth-first search outwards from the given cells, which already have
+ * their distances; open cells it improves are updated and searched on */
+static void spread(DistanceField *field, const Snake *snake, int count) {
+    int head = 0;
+
+    while (head < count) {
+        int cell = field->queue[head++];
+        int next = field->distance[cell] + 1;
+        for (int dir = 0; dir < 4; dir++) {
+            int to = neighbour(cell, dir);
+            if (next < field->distance[to] && isOpen(snake, to)) {
+                field->distance[to] = next;
+                field->queue[count++] = to;
+            }
+        }
+    }
+}
+
+/* Search the whole board from the food */
+void buildDistanceField(DistanceField *field, const Game *game) {
+    for (int i = 0; i < CELL_COUNT; i++) {
+        field->distance[i] = DISTANCE_NONE;
+    }
+    for (int i = 0; i < GRID_WORDS; i++) {
+        field->affected[i] = 0;
+    }
+    int food = cellIndex(game->food);
+    field->distance[food] = 0;
+    field->queue[0] = food;
+    spread(field, &game->snake, 1);
+    noteSnake(field, game);
+    field->rebuilds++;
+}
+
+/* True if a cell still has a neighbour one step nearer the food that is
+ * not itself being repaired */
+static bool isSupported(const DistanceField *field, int cell) {
+    int want = field->distance[cell] - 1;
+    for (int dir = 0; dir < 4; dir++) {
+        int from = neighbour(cell, dir);
+        if (field->distance[from] == want && !isAffected(field, from)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int compareSeeds(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* The body now covers a cell that was open */
+static void closeCell(DistanceField *field, const Snake *snake, int closed) {
+    int level = field->distance[closed];
+    int count = 0;
+
+    field->distance[closed] = DISTANCE_NONE;
+    if (level == DISTANCE_NONE) {
+        return;
+    }
+
+    /* Find the cells that lost every shortest path. Walking outwards level
+     * by level, a cell's nearer neighbours are all settled before it is
+     * looked at. The closed cell is looked at first, at its old level. */
+    for (int next = -1; next < count; next++) {
+        int cell = next < 0 ? closed : field->queue[next];
+        int at = next < 0 ? level : field->distance[cell];
+        for (int dir = 0; dir < 4; dir++) {
+            int to = neighbour(cell, dir);
+            if (field->distance[to] == at + 1 && !isAffected(field, to) &&
+                !isSupported(field, to)) {
+                setAffected(field, to, true);
+                field->queue[count++] = to;
+            }
+        }
+    }
+
+    /* Each takes its best distance through the cells that kept theirs */
+    int seeds = 0;
+    for (int i = 0; i < count; i++) {
+        int cell = field->queue[i];
+        int best = DISTANCE_NONE;
+        for (int dir = 0; dir < 4; dir++) {
+            int from = neighbour(cell, dir);
+            if (!isAffected(field, from) && field->distance[from] + 1 < best) {
+                best = field->distance[from] + 1;
+            }
+        }
+        if (best < DISTANCE_NONE) {
+            field->seeds[seeds++] = (uint64_t)best << 32 | (uint64_t)cell;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        field->distance[field->queue[i]] = DISTANCE_NONE;
+        setAffected(field, field->queue[i], false);
+    }
+
+    /* Then search from those, nearest first. Merging the sorted seeds with
+     * the queue keeps every cell coming out in order of distance, so the
+     * first distance a cell is given is its final one. */
+    qsort(field->seeds, seeds, sizeof(uint64_t), compareSeeds);
+    int head = 0;
+    int tail = 0;
+    int s = 0;
+    while (s < seeds || head < tail) {
+        int cell;
+        if (head == tail || (s < seeds &&
+                             (int)(field->seeds[s] >> 32) <= field->distance[field->queue[head]])) {
+            cell = (int)(uint32_t)field->seeds[s];
+            int seeded = (int)(field->seeds[s++] >> 32);
+            if (field->distance[cell] <= seeded) {
+                continue;
+            }
+            field->distance[cell] = seeded;
+        } else {
+            cell = field->queue[head++];
+        }
+        int next = field->distance[cell] + 1;
+        for (int dir = 0; dir < 4; dir++) {
+            int to = neighbour(cell, dir);
+            if (next < field->distance[to] && isOpen(snake, to)) {
+                field->distance[to] = next;
+                field->queue[tail++] = to;
+            }
+        }
+    }
+}
+
+/* The body has left a cell */
+static void openCell(DistanceField *field, const Snake *snake, int opened) {
+    int best = DISTANCE_NONE;
+
+    for (int dir = 0; dir < 4; dir++) {
+        int from = neighbour(opened, dir);
+        if (field->distance[from] + 1 < best) {
+            best = field->distance[from] + 1;
+        }
+    }
+    if (best < field->distance[opened]) {
+        field->distance[opened] = best;
+        field->queue[0] = opened;
+        spread(field, snake, 1);
+    }
+}
+
+/* Bring the field up to date with the game. After one ordinary move it is
+ * repaired; a new food position, or any other change, rebuilds it. */
+void updateDistanceField(DistanceField *field, const Game *game) {
+    const Snake *snake = &game->snake;
+
+    if (!field->valid || game->food.x != field->food.x || game->food.y != field->food.y ||
+        snake->moves != field->moves + 1 || snake->size < 2 || snake->bitten) {
+        buildDistanceField(field, game);
+        return;
+    }
+    Point neck = snakeSegment(snake, 1);
+    if (neck.x != field->head.x || neck.y != field->head.y) {
+        buildDistanceField(field, game);
+        return;
+    }
+
+    /* The head's cell first: the old tail cell still reads as covered */
+    closeCell(field, snake, cellIndex(snakeSegment(snake, 0)));
+    if (isOpen(snake, cellIndex(field->tail))) {
+        openCell(field, snake, cellIndex(field->tail));
+    }
+    noteSnake(field, game);
+    field->repairs++;
+}
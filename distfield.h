@@ -0,0 +1,54 @@
+/**
+ * Snake Game - Distance Field to the Food
+ *
+ * For every free cell, the number of moves to the food around the body (the
+ * walls wrap, as in the game). Building it is a breadth-first search from
+ * the food, but a game only needs that when the food moves. On every other
+ * tick the snake changes two cells, and the field is repaired around them:
+ *
+ *   - the head's new cell becomes a wall. Only the cells whose shortest
+ *     paths all ran through it can get further away; they are found by
+ *     walking outwards from it, and given new distances from the cells
+ *     around them that kept theirs.
+ *   - the tail's old cell opens up. It takes its distance from its
+ *     neighbours, and any cell it brings closer is updated in turn.
+ *
+ * Either way, only the cells whose distance actually changes are visited,
+ * which on a big board is a small patch around the snake. A bot then picks
+ * its move with one lookup per direction.
+ */
+
+#ifndef DISTFIELD_H
+#define DISTFIELD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+
+#define DISTANCE_NONE CELL_COUNT  // Covered, or cut off from the food
+
+/* The field, with scratch space for the repairs */
+typedef struct {
+    int distance[CELL_COUNT];        // Moves to the food, or DISTANCE_NONE
+    int queue[CELL_COUNT];
+    uint64_t seeds[CELL_COUNT];      // Repaired cells by new distance
+    uint64_t affected[GRID_WORDS];
+    Point food;                      // Where the field leads to
+    Point head;                      // The snake it was last brought up to date with
+    Point tail;
+    int moves;
+    bool valid;
+    long long rebuilds;              // Full searches done
+    long long repairs;               // Ticks handled by repairing instead
+} DistanceField;
+
+/* Moves from a cell to the food; DISTANCE_NONE if it cannot get there */
+static inline int distanceToFood(const DistanceField *field, Point p) {
+    return field->distance[cellIndex(p)];
+}
+
+/* Function prototypes */
+void buildDistanceField(DistanceField *field, const Game *game);
+void updateDistanceField(DistanceField *field, const Game *game);
+
+#endif /* DISTFIELD_H */
@@ -0,0 +1,65 @@
+/**
+ * Example bot plugin: heads for the food, avoiding its own body.
+ *
+ * Build with: make plugins
+ * Play with:  ./snake --ai plugin --plugin examples/bot_greedy.so
+ */
+
+#include <stdlib.h>
+#include "../snake_bot.h"
+
+/* Where a point ends up after one step, tunnelling through the wall */
+static SnakeBotPoint step(const SnakeBotView *view, SnakeBotPoint p, int dir) {
+    static const int dx[4] = { 0, 1, 0, -1 };
+    static const int dy[4] = { -1, 0, 1, 0 };
+
+    p.x += dx[dir];
+    p.y += dy[dir];
+    if (p.x <= 0) p.x = view->width - 2;
+    else if (p.x >= view->width - 1) p.x = 1;
+    if (p.y <= 0) p.y = view->height - 2;
+    else if (p.y >= view->height - 1) p.y = 1;
+    return p;
+}
+
+/* Distance along one wrapping axis */
+static int axisDistance(int a, int b, int size) {
+    int d = abs(a - b);
+    int inner = size - 2;
+    return d < inner - d ? d : inner - d;
+}
+
+static int greedyMove(void *state, const SnakeBotView *view) {
+    SnakeBotPoint head = snake_bot_segment(view, 0);
+    SnakeBotPoint tail = snake_bot_segment(view, view->size - 1);
+    int best = view->direction;
+    int bestDistance = 1 << 30;
+
+    (void)state;
+    for (int dir = 0; dir < 4; dir++) {
+        if (dir == (view->direction + 2) % 4) {
+            continue;  // Reversing is not allowed
+        }
+
+        SnakeBotPoint next = step(view, head, dir);
+        if (snake_bot_occupied(view, next) && !(next.x == tail.x && next.y == tail.y)) {
+            continue;
+        }
+
+        int distance = axisDistance(next.x, view->food.x, view->width) +
+                       axisDistance(next.y, view->food.y, view->height);
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = dir;
+        }
+    }
+    return best;
+}
+
+static const SnakeBotPlugin PLUGIN = {
+    SNAKE_BOT_ABI_VERSION, "greedy-plugin", NULL, greedyMove, NULL
+};
+
+const SnakeBotPlugin *snake_bot_entry(void) {
+    return &PLUGIN;
+}
@@ -0,0 +1,133 @@
+/**
+ * Example shared-memory bot: the greedy strategy of bot_greedy.c, running
+ * in its own process and talking to the game through snake_shm.h.
+ *
+ * Build with: make examples
+ * Play with:  ./snake --ai shm            (in one terminal)
+ *             examples/shm_client         (in another)
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../snake_shm.h"
+
+/* Where a point ends up after one step, tunnelling through the wall */
+static SnakeBotPoint step(const SnakeShmHeader *shm, SnakeBotPoint p, int dir) {
+    static const int dx[4] = { 0, 1, 0, -1 };
+    static const int dy[4] = { -1, 0, 1, 0 };
+
+    p.x += dx[dir];
+    p.y += dy[dir];
+    if (p.x <= 0) p.x = shm->width - 2;
+    else if (p.x >= shm->width - 1) p.x = 1;
+    if (p.y <= 0) p.y = shm->height - 2;
+    else if (p.y >= shm->height - 1) p.y = 1;
+    return p;
+}
+
+/* Distance along one wrapping axis */
+static int axisDistance(int a, int b, int size) {
+    int d = abs(a - b);
+    int inner = size - 2;
+    return d < inner - d ? d : inner - d;
+}
+
+/* Head for the food, avoiding the body */
+static int greedyMove(const SnakeShmHeader *shm, const SnakeShmState *state,
+                      const SnakeBotPoint *body, const uint64_t *grid) {
+    SnakeBotPoint head = body[0];
+    SnakeBotPoint tail = body[state->size - 1];
+    int best = state->direction;
+    int bestDistance = 1 << 30;
+
+    for (int dir = 0; dir < 4; dir++) {
+        if (dir == (state->direction + 2) % 4) {
+            continue;  // Reversing is not allowed
+        }
+
+        SnakeBotPoint next = step(shm, head, dir);
+        int cell = next.y * shm->width + next.x;
+        int covered = (int)((grid[cell >> 6] >> (cell & 63)) & 1);
+        if (covered && !(next.x == tail.x && next.y == tail.y)) {
+            continue;
+        }
+
+        int distance = axisDistance(next.x, state->food.x, shm->width) +
+                       axisDistance(next.y, state->food.y, shm->height);
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = dir;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    const char *name = argc > 1 ? argv[1] : SNAKE_SHM_DEFAULT_NAME;
+    struct stat info;
+
+    /* Map the region the game created */
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        fprintf(stderr, "Cannot open %s (is the game running with --ai shm?)\n", name);
+        return 1;
+    }
+    SnakeShmHeader *shm = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE,
+                               MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED ||
+        __atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != SNAKE_SHM_MAGIC ||
+        shm->version != SNAKE_SHM_VERSION) {
+        fprintf(stderr, "%s is not a snake bot region of version %d\n", name,
+                SNAKE_SHM_VERSION);
+        return 1;
+    }
+
+    SnakeBotPoint *body = malloc(shm->ringCapacity * sizeof(SnakeBotPoint));
+    uint64_t *grid = malloc(shm->gridWords * sizeof(uint64_t));
+    if (body == NULL || grid == NULL) {
+        return 1;
+    }
+
+    /* Announce ourselves; the game waits for this before the first tick */
+    uint32_t seen = __atomic_load_n(&shm->turn, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&shm->clientPid, (uint32_t)getpid(), __ATOMIC_RELEASE);
+    snake_shm_wake(&shm->clientPid);
+
+    long moves = 0;
+    int score = 0;
+    for (;;) {
+        /* Sleep until the game bumps the turn word */
+        uint32_t turn;
+        while ((turn = __atomic_load_n(&shm->turn, __ATOMIC_ACQUIRE)) == seen) {
+            snake_shm_wait(&shm->turn, seen, NULL);
+        }
+        seen = turn;
+        if (__atomic_load_n(&shm->closed, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+
+        SnakeShmState state;
+        snake_shm_read(shm, &state, body, grid);
+        score = state.score;
+
+        /* The move must be visible before the reply that announces it */
+        __atomic_store_n(&shm->move, greedyMove(shm, &state, body, grid),
+                         __ATOMIC_RELAXED);
+        __atomic_store_n(&shm->reply, turn, __ATOMIC_RELEASE);
+        snake_shm_wake(&shm->reply);
+        moves++;
+    }
+
+    printf("Game over after %ld moves, score %d\n", moves, score);
+    free(body);
+    free(grid);
+    munmap(shm, (size_t)info.st_size);
+    return 0;
+}
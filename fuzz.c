@@ -0,0 +1,669 @@
+/**
+ * Snake Game - Simulation Fuzzer (snake-fuzz)
+ *
+ * Plays huge numbers of headless games with random and adversarial inputs
+ * and checks the core's invariants after every single tick:
+ *
+ *   - every segment is inside the border and next to the one before it
+ *   - the heading is the direction from the neck to the head
+ *   - body cells are unique, except the doubled tail right after eating and
+ *     the head on the tick the snake bites itself (which must end the game)
+ *   - the occupancy grid has exactly the cells the body covers
+ *   - every covered cell's free-at entry says when the tail leaves it
+ *   - the Zobrist hash kept by the moves matches one computed afresh
+ *   - the distance field repaired tick by tick matches one built afresh
+ *   - the food is inside the border and never under the body
+ *   - the score (size - INITIAL_SIZE) matches the food actually eaten
+ *   - the game is won exactly when the body covers the whole board
+ *   - applyMove() followed by undoMove() restores the exact state
+ *
+ * The board is small by default (see FUZZ_BOARD in the Makefile), so games
+ * reach the rare states - a nearly full board, food with one free cell left -
+ * thousands of times per second instead of once in a blue moon.
+ *
+ * Every game has its own seed. When a check fails, the seed is printed, and
+ * --replay SEED plays that game again and shows the board at the failure.
+ *
+ * With --placement it tests placeFood() instead: it builds snakes of every
+ * length, places food on each board many times over, and runs a chi-square
+ * test per board on the counts of the free cells. The p-values of a fair
+ * placement are spread evenly over [0, 1], so a second chi-square test over
+ * their histogram catches a small bias that no single board would show.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "game.h"
+#include "distfield.h"
+#include "clock.h"
+
+/* Fuzzer Limits */
+#define FUZZ_MAX_THREADS 256
+#define FUZZ_MAX_TICKS   (PLAY_CELLS * PLAY_CELLS * 4)  // Per game
+#define FUZZ_UNDO_ODDS   8     // One tick in this many also checks undo
+#define FUZZ_FIELD_EVERY 4     // Compare the distance field every this many ticks
+
+/* Food placement test */
+#define PLACEMENT_PER_CELL 1000   // Expected placements per free cell per board
+#define PLACEMENT_ALPHA    0.001  // Significance level of each test
+#define PVALUE_BINS        10     // Histogram of the per-board p-values
+
+/* Input strategies; each game picks one */
+#define STRATEGY_RANDOM   0  // Any direction, reversals included
+#define STRATEGY_STRAIGHT 1  // Mostly straight, with the odd random turn
+#define STRATEGY_SAFE     2  // A random move that does not bite, if any
+#define STRATEGY_CYCLE    3  // Follow a Hamiltonian cycle to fill the board
+#define STRATEGY_COUNT    4
+
+/* Why games ended */
+#define END_BITE  0
+#define END_FULL  1   // The snake covers every cell
+#define END_LIMIT 2   // FUZZ_MAX_TICKS reached
+#define END_COUNT 3
+
+/* One thread's counters */
+typedef struct {
+    long long ticks;
+    long long games;
+    long long ends[END_COUNT];
+    int longest;
+    long long placements;            // --placement: food placed
+    long long rejected;              // Boards whose test failed at PLACEMENT_ALPHA
+    long long pvalues[PVALUE_BINS];  // Boards per p-value bin
+} FuzzStats;
+
+/* Everything shared between the fuzzing threads */
+typedef struct {
+    uint64_t seed;
+    double deadline;          // secondsNow() at which to stop
+    long long maxGames;       // Per thread, 0 for no limit
+    bool placement;           // Test food placement instead of playing
+    int failed;               // Set (atomically) by the first failure
+    uint64_t failedSeed;
+    FuzzStats stats[FUZZ_MAX_THREADS];
+} Fuzzer;
+
+/* A thread's slot in the fuzzer */
+typedef struct {
+    Fuzzer *fuzzer;
+    int index;
+} FuzzThread;
+
+/* Direction to take from each cell to follow the Hamiltonian cycle */
+static int cycleDirection[CELL_COUNT];
+static bool cycleExists;
+
+/* Function prototypes */
+void buildCycle(void);
+void *fuzzThread(void *arg);
+int fuzzGame(uint64_t seed, Arena *arena, FuzzStats *stats, bool verbose);
+int placementTest(uint64_t seed, Arena *arena, FuzzStats *stats);
+double chiSquareP(double x, int df);
+int chooseInput(const Game *game, int strategy, uint64_t *rng);
+const char *checkInvariants(const Game *game, int score, bool ate);
+uint64_t hashGame(const Game *game);
+void printBoard(const Game *game);
+uint64_t mixSeed(uint64_t a, uint64_t b);
+void usage(const char *program);
+
+/* Main function - entry point of the program */
+int main(int argc, char *argv[]) {
+    static Fuzzer fuzzer;
+    double seconds = 10.0;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    bool replay = false;
+    uint64_t replaySeed = 0;
+
+    fuzzer.seed = (uint64_t)time(NULL);
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            fuzzer.maxGames = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            fuzzer.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--placement") == 0) {
+            fuzzer.placement = true;
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay = true;
+            replaySeed = strtoull(argv[++i], NULL, 10);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (threads > FUZZ_MAX_THREADS) threads = FUZZ_MAX_THREADS;
+
+    buildCycle();
+
+    /* Replay one game and show where it went wrong */
+    if (replay) {
+        Arena arena;
+        FuzzStats stats;
+        memset(&stats, 0, sizeof(stats));
+        if (!arenaInit(&arena, GAME_ARENA_BYTES)) {
+            return 1;
+        }
+        int failed = fuzzGame(replaySeed, &arena, &stats, true);
+        printf("Game %llu: %s after %lld ticks, length %d\n",
+               (unsigned long long)replaySeed, failed ? "FAILED" : "passed",
+               stats.ticks, stats.longest);
+        arenaFree(&arena);
+        return failed;
+    }
+
+    printf("Fuzzing a %dx%d board on %d threads for %.0f s (seed %llu)\n",
+           WIDTH, HEIGHT, threads, seconds, (unsigned long long)fuzzer.seed);
+
+    double start = secondsNow();
+    fuzzer.deadline = start + seconds;
+
+    pthread_t workers[FUZZ_MAX_THREADS];
+    FuzzThread slots[FUZZ_MAX_THREADS];
+    for (int t = 0; t < threads; t++) {
+        slots[t].fuzzer = &fuzzer;
+        slots[t].index = t;
+        pthread_create(&workers[t], NULL, fuzzThread, &slots[t]);
+    }
+
+    /* Merge the per-thread counters */
+    FuzzStats total;
+    memset(&total, 0, sizeof(total));
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t], NULL);
+        total.ticks += fuzzer.stats[t].ticks;
+        total.games += fuzzer.stats[t].games;
+        total.placements += fuzzer.stats[t].placements;
+        total.rejected += fuzzer.stats[t].rejected;
+        for (int b = 0; b < PVALUE_BINS; b++) {
+            total.pvalues[b] += fuzzer.stats[t].pvalues[b];
+        }
+        for (int e = 0; e < END_COUNT; e++) {
+            total.ends[e] += fuzzer.stats[t].ends[e];
+        }
+        if (fuzzer.stats[t].longest > total.longest) {
+            total.longest = fuzzer.stats[t].longest;
+        }
+    }
+    double elapsed = secondsNow() - start;
+
+    if (fuzzer.placement) {
+        /* Second level: are the p-values spread evenly? */
+        double expected = (double)total.games / PVALUE_BINS;
+        double chi = 0.0;
+        for (int b = 0; b < PVALUE_BINS && expected > 0; b++) {
+            chi += (total.pvalues[b] - expected) * (total.pvalues[b] - expected) / expected;
+        }
+        double spread = expected > 0 ? chiSquareP(chi, PVALUE_BINS - 1) : 1.0;
+        double allowed = total.games * PLACEMENT_ALPHA;
+
+        printf("%lld placements on %lld boards (%.2f M placements/s)\n",
+               total.placements, total.games, total.placements / elapsed / 1e6);
+        printf("Boards rejected at p < %g: %lld (about %.1f expected)\n",
+               PLACEMENT_ALPHA, total.rejected, allowed);
+        printf("p-value histogram:");
+        for (int b = 0; b < PVALUE_BINS; b++) {
+            printf(" %lld", total.pvalues[b]);
+        }
+        printf("\nEvenness of the p-values: p = %.4f\n", spread);
+
+        /* Rejections are binomial, so allow a few standard deviations */
+        if (fuzzer.failed || spread < PLACEMENT_ALPHA ||
+            total.rejected > allowed + 4.0 * sqrt(allowed) + 3.0) {
+            printf("FAILED: food placement is not uniform\n");
+            return 1;
+        }
+        printf("Food placement is uniform\n");
+        return 0;
+    }
+
+    printf("%lld ticks in %lld games (%.2f M ticks/s)\n", total.ticks, total.games,
+           total.ticks / elapsed / 1e6);
+    printf("Endings: %lld bites, %lld full boards, %lld tick limits; "
+           "longest snake %d of %d cells\n", total.ends[END_BITE],
+           total.ends[END_FULL], total.ends[END_LIMIT], total.longest, PLAY_CELLS);
+
+    if (fuzzer.failed) {
+        printf("FAILED: replay with --replay %llu\n",
+               (unsigned long long)fuzzer.failedSeed);
+        return 1;
+    }
+    printf("All invariants held\n");
+    return 0;
+}
+
+/* Lay out a cycle through every play cell: along the rows in a zigzag,
+ * then back up the first column. This needs an even number of rows. */
+void buildCycle(void) {
+    int columns = WIDTH - 2;
+    int rows = HEIGHT - 2;
+
+    cycleExists = rows % 2 == 0 && columns >= 2;
+    if (!cycleExists) {
+        return;
+    }
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < columns; c++) {
+            int direction;
+            if (c == 0) {
+                direction = r > 0 ? UP : RIGHT;
+            } else if (r % 2 == 0) {
+                direction = c < columns - 1 ? RIGHT : DOWN;
+            } else if (c > 1) {
+                direction = LEFT;
+            } else {
+                direction = r < rows - 1 ? DOWN : LEFT;
+            }
+            Point p = { c + 1, r + 1 };
+            cycleDirection[cellIndex(p)] = direction;
+        }
+    }
+}
+
+/* Play games until the deadline, the game limit or the first failure */
+void *fuzzThread(void *arg) {
+    FuzzThread *slot = arg;
+    Fuzzer *fuzzer = slot->fuzzer;
+    FuzzStats *stats = &fuzzer->stats[slot->index];
+    Arena arena;
+
+    if (!arenaInit(&arena, GAME_ARENA_BYTES)) {
+        return NULL;
+    }
+
+    uint64_t threadSeed = mixSeed(fuzzer->seed, (uint64_t)slot->index + 1);
+    for (uint64_t n = 0; ; n++) {
+        if (__atomic_load_n(&fuzzer->failed, __ATOMIC_RELAXED) ||
+            (fuzzer->maxGames > 0 && stats->games >= fuzzer->maxGames)) {
+            break;
+        }
+        /* Checking the clock every game is cheap next to playing one */
+        if (fuzzer->maxGames == 0 && secondsNow() >= fuzzer->deadline) {
+            break;
+        }
+
+        uint64_t seed = mixSeed(threadSeed, n);
+        int failed = fuzzer->placement ? placementTest(seed, &arena, stats)
+                                       : fuzzGame(seed, &arena, stats, false);
+        if (failed) {
+            if (!__atomic_exchange_n(&fuzzer->failed, 1, __ATOMIC_RELAXED)) {
+                fuzzer->failedSeed = seed;
+            }
+            break;
+        }
+    }
+
+    arenaFree(&arena);
+    return NULL;
+}
+
+/* Play one game, checking every tick. Returns 1 if an invariant broke. */
+int fuzzGame(uint64_t seed, Arena *arena, FuzzStats *stats, bool verbose) {
+    static __thread DistanceField repaired, fresh;
+    Game game;
+    MoveUndo undo;
+    uint64_t rng = mixSeed(seed, 0x5EED);
+    int strategy = (int)(gameRandom(&rng) % STRATEGY_COUNT);
+    int score = 0;
+    int end = END_LIMIT;
+    int tick = 0;
+
+    arenaReset(arena);
+    if (!initializeGame(&game, arena, seed)) {
+        return 0;
+    }
+
+    repaired.valid = false;
+    updateDistanceField(&repaired, &game);
+
+    const char *failure = checkInvariants(&game, score, false);
+    for (; failure == NULL && tick < FUZZ_MAX_TICKS; tick++) {
+        int direction = chooseInput(&game, strategy, &rng);
+
+        /* Now and then, check that the move can be taken back exactly */
+        if (gameRandom(&rng) % FUZZ_UNDO_ODDS == 0) {
+            uint64_t before = hashGame(&game);
+            applyMove(&game, direction, &undo);
+            undoMove(&game, &undo);
+            if (hashGame(&game) != before) {
+                failure = "undoMove() did not restore the state";
+                break;
+            }
+        }
+
+        bool ate = applyMove(&game, direction, &undo);
+        score += ate;
+        stats->ticks++;
+        if (game.snake.size - ate > stats->longest) {
+            stats->longest = game.snake.size - ate;
+        }
+
+        failure = checkInvariants(&game, score, ate);
+        if (failure == NULL && !game.gameOver) {
+            updateDistanceField(&repaired, &game);
+        }
+        if (failure == NULL && !game.gameOver && tick % FUZZ_FIELD_EVERY == 0) {
+            buildDistanceField(&fresh, &game);
+            if (memcmp(repaired.distance, fresh.distance, sizeof(fresh.distance)) != 0) {
+                failure = "repaired distance field differs from a fresh one";
+            }
+        }
+        if (failure == NULL && game.gameOver) {
+            end = game.won ? END_FULL : END_BITE;
+            break;
+        }
+    }
+
+    stats->games++;
+    if (failure != NULL) {
+        fprintf(stderr, "Game %llu (strategy %d), tick %d: %s\n",
+                (unsigned long long)seed, strategy, tick, failure);
+        if (verbose) {
+            printBoard(&game);
+        }
+        return 1;
+    }
+    stats->ends[end]++;
+    return 0;
+}
+
+/* Grow a snake to a random length, then place food on its board many times
+ * and test the counts. Returns 1 if food ever landed on the body. */
+int placementTest(uint64_t seed, Arena *arena, FuzzStats *stats) {
+    static __thread uint32_t counts[CELL_COUNT];
+    Game game;
+    MoveUndo undo;
+    uint64_t rng = mixSeed(seed, 0xF00D);
+    int strategy = gameRandom(&rng) & 1 ? STRATEGY_CYCLE : STRATEGY_SAFE;
+    int length = INITIAL_SIZE + (int)gameRandomBelow(&rng, PLAY_CELLS - INITIAL_SIZE);
+
+    arenaReset(arena);
+    if (!initializeGame(&game, arena, seed)) {
+        return 0;
+    }
+
+    /* Play towards the target length; a move that would end the game is
+     * taken back, and the board as it stands is tested instead */
+    for (int tick = 0; game.snake.size < length && tick < FUZZ_MAX_TICKS; tick++) {
+        applyMove(&game, chooseInput(&game, strategy, &rng), &undo);
+        stats->ticks++;
+        if (game.gameOver) {
+            undoMove(&game, &undo);
+            break;
+        }
+    }
+
+    int freeCount = freeCells(&game.snake);
+    if (freeCount < 2) {
+        return 0;
+    }
+
+    memset(counts, 0, sizeof(counts));
+    long long samples = (long long)freeCount * PLACEMENT_PER_CELL;
+    for (long long i = 0; i < samples; i++) {
+        placeFood(&game);
+        if (isOccupied(&game.snake, game.food)) {
+            fprintf(stderr, "Board %llu: food placed on the body\n",
+                    (unsigned long long)seed);
+            return 1;
+        }
+        counts[cellIndex(game.food)]++;
+    }
+    stats->placements += samples;
+    stats->games++;
+
+    /* Chi-square over the free cells, each expected PLACEMENT_PER_CELL times */
+    double chi = 0.0;
+    for (int y = 1; y < HEIGHT - 1; y++) {
+        for (int x = 1; x < WIDTH - 1; x++) {
+            Point p = { x, y };
+            if (!isOccupied(&game.snake, p)) {
+                double d = counts[cellIndex(p)] - (double)PLACEMENT_PER_CELL;
+                chi += d * d / PLACEMENT_PER_CELL;
+            }
+        }
+    }
+    double p = chiSquareP(chi, freeCount - 1);
+    int bin = (int)(p * PVALUE_BINS);
+    stats->pvalues[bin < PVALUE_BINS ? bin : PVALUE_BINS - 1]++;
+    if (p < PLACEMENT_ALPHA) {
+        stats->rejected++;
+    }
+    return 0;
+}
+
+/* Chance of a chi-square statistic at least this large with 'df' degrees of
+ * freedom (Wilson-Hilferty: the cube root is close to normal) */
+double chiSquareP(double x, int df) {
+    double k = df;
+    double z = (cbrt(x / k) - (1.0 - 2.0 / (9.0 * k))) / sqrt(2.0 / (9.0 * k));
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+/* Pick the next input for a strategy */
+int chooseInput(const Game *game, int strategy, uint64_t *rng) {
+    const Snake *snake = &game->snake;
+    uint32_t r = gameRandom(rng);
+
+    switch (strategy) {
+        case STRATEGY_STRAIGHT:
+            return (r & 7) == 0 ? (int)((r >> 3) & 3) : snake->direction;
+
+        case STRATEGY_SAFE: {
+            /* Start at a random direction and take the first safe one */
+            Point tail = snakeSegment(snake, snake->size - 1);
+            for (int i = 0; i < 4; i++) {
+                int direction = (int)((r + i) & 3);
+                Point next = nextHead(snake, direction);
+                if (direction == OPPOSITE(snake->direction)) {
+                    continue;
+                }
+                if (!isOccupied(snake, next) || (next.x == tail.x && next.y == tail.y)) {
+                    return direction;
+                }
+            }
+            return (int)(r & 3);
+        }
+
+        case STRATEGY_CYCLE:
+            if (cycleExists) {
+                return cycleDirection[cellIndex(snakeSegment(snake, 0))];
+            }
+            return (int)(r & 3);
+
+        default:
+            return (int)(r & 3);
+    }
+}
+
+/* Check the invariants listed at the top. 'ate' says if the last move ate.
+ * Returns NULL if all hold, else a description of the first that broke. */
+const char *checkInvariants(const Game *game, int score, bool ate) {
+    const Snake *snake = &game->snake;
+    uint64_t seen[GRID_WORDS];
+    bool bitten = false;
+    int headCell = cellIndex(snakeSegment(snake, 0));
+
+    memset(seen, 0, sizeof(seen));
+
+    if (snake->size < 1 || snake->size - ate > PLAY_CELLS || snake->size > snake->capacity) {
+        return "snake size out of range";
+    }
+    if (snake->size - INITIAL_SIZE != score) {
+        return "score does not match the food eaten";
+    }
+    Point head = snakeSegment(snake, 0);
+    Point led = movePoint(snakeSegment(snake, 1), snake->heading);
+    if (snake->heading < 0 || snake->heading > 3 || led.x != head.x || led.y != head.y) {
+        return "heading is not the step from the neck to the head";
+    }
+
+    for (int i = 0; i < snake->size; i++) {
+        Point p = snakeSegment(snake, i);
+        if (p.x < 1 || p.x > WIDTH - 2 || p.y < 1 || p.y > HEIGHT - 2) {
+            return "segment outside the board";
+        }
+
+        /* Neighbouring segments are one step apart (or equal at a fresh tail) */
+        bool same = false;
+        if (i > 0) {
+            Point previous = snakeSegment(snake, i - 1);
+            same = previous.x == p.x && previous.y == p.y;
+            bool adjacent = false;
+            for (int d = 0; d < 4 && !adjacent; d++) {
+                Point step = movePoint(previous, d);
+                adjacent = step.x == p.x && step.y == p.y;
+            }
+            if (same && !(ate && i == snake->size - 1)) {
+                return "doubled segment other than a freshly grown tail";
+            }
+            if (!same && !adjacent) {
+                return "segments are not adjacent";
+            }
+        }
+
+        /* The first segment in a cell is the one that leaves it last */
+        int cell = cellIndex(p);
+        uint64_t bit = 1ULL << (cell & 63);
+        if (!(seen[cell >> 6] & bit) && cellFreeIn(snake, p) != snake->size - i) {
+            return "free-at grid does not match the body";
+        }
+        if (seen[cell >> 6] & bit) {
+            if (same) {
+                continue;  // The grown tail, checked above
+            }
+            /* Otherwise only a bite may put two segments in one cell */
+            if (cell != headCell || bitten) {
+                return "two body segments share a cell";
+            }
+            if (!game->gameOver) {
+                return "body overlaps itself but the game is not over";
+            }
+            bitten = true;
+        }
+        seen[cell >> 6] |= bit;
+    }
+
+    /* The board is full once the body covers every cell */
+    int covered = 0;
+    for (int i = 0; i < GRID_WORDS; i++) {
+        covered += __builtin_popcountll(seen[i]);
+    }
+    bool full = covered == PLAY_CELLS;
+    if (game->won != full) {
+        return full ? "board is full but the game is not won"
+                    : "game won before the board is full";
+    }
+    if (game->won && !game->gameOver) {
+        return "game won but not over";
+    }
+    if (game->gameOver && !bitten && !game->won) {
+        return "game over without a bite";
+    }
+    if (memcmp(seen, snake->occupied, sizeof(seen)) != 0) {
+        return "occupancy grid does not match the body";
+    }
+    if (gameHash(game) != computeGameHash(game)) {
+        return "state hash does not match the state";
+    }
+
+    /* The food only matters while the game goes on */
+    if (!game->gameOver) {
+        Point food = game->food;
+        if (food.x < 1 || food.x > WIDTH - 2 || food.y < 1 || food.y > HEIGHT - 2) {
+            return "food outside the board";
+        }
+        if (isOccupied(snake, food)) {
+            return "food under the body";
+        }
+    }
+    return NULL;
+}
+
+/* FNV-1a over everything undoMove() has to restore */
+uint64_t hashGame(const Game *game) {
+    const Snake *snake = &game->snake;
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    uint64_t words[6 + GRID_WORDS];
+    int n = 0;
+
+    /* The ring position is left out: growing the body moves the ring, and
+     * undoMove() only has to restore the segments, not where they sit */
+
+    words[n++] = (uint64_t)snake->size | (uint64_t)snake->direction << 32 |
+                 (uint64_t)snake->heading << 48;
+    words[n++] = (uint64_t)game->food.x | (uint64_t)game->food.y << 32;
+    words[n++] = game->rng;
+    words[n++] = game->gameOver | (uint64_t)game->won << 1;
+    words[n++] = snake->bitten;
+    words[n++] = snake->hash;
+    for (int i = 0; i < GRID_WORDS; i++) {
+        words[n++] = snake->occupied[i];
+    }
+    for (int i = 0; i < n; i++) {
+        hash = (hash ^ words[i]) * 0x100000001B3ULL;
+    }
+    for (int i = 0; i < snake->size; i++) {
+        Point p = snakeSegment(snake, i);
+        hash = (hash ^ (uint64_t)(p.x | p.y << 16)) * 0x100000001B3ULL;
+        hash = (hash ^ (uint64_t)cellFreeIn(snake, p)) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+/* Show the board: @ head, o body, * food, # where several segments overlap */
+void printBoard(const Game *game) {
+    char board[HEIGHT][WIDTH + 1];
+
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            bool border = x == 0 || y == 0 || x == WIDTH - 1 || y == HEIGHT - 1;
+            board[y][x] = border ? '+' : '.';
+        }
+        board[y][WIDTH] = '\0';
+    }
+    board[game->food.y][game->food.x] = '*';
+    for (int i = game->snake.size - 1; i >= 0; i--) {
+        Point p = snakeSegment(&game->snake, i);
+        char *c = &board[p.y][p.x];
+        *c = i == 0 ? '@' : (*c == 'o' || *c == '@') ? '#' : 'o';
+    }
+    for (int y = 0; y < HEIGHT; y++) {
+        printf("%s\n", board[y]);
+    }
+    printf("size %d, direction %d, food (%d,%d), game over %d\n", game->snake.size,
+           game->snake.direction, game->food.x, game->food.y, game->gameOver);
+}
+
+/* Combine two numbers into a well-mixed seed (splitmix64 finaliser) */
+uint64_t mixSeed(uint64_t a, uint64_t b) {
+    uint64_t z = a + 0x9E3779B97F4A7C15ULL * (b + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return z ? z : 1;
+}
+
+/* Print command line help */
+void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --seconds N    How long to fuzz (default 10)\n");
+    fprintf(stderr, "  --games N      Stop after N games per thread instead\n");
+    fprintf(stderr, "  --threads N    Worker threads (default: one per CPU)\n");
+    fprintf(stderr, "  --seed N       Base seed (default: the clock)\n");
+    fprintf(stderr, "  --replay SEED  Play one game again and show the failure\n");
+    fprintf(stderr, "  --placement    Test that food placement is uniform instead\n");
+}
@@ -0,0 +1,601 @@
+/**
+ * Snake Game - Headless Core
+ *
+ * The game rules, moved out of snake.c so they can run without ncurses.
+ * The interactive game, the AI controllers and any batch tools all call the
+ * same functions, so a rule change only ever has to be made in one place.
+ *
+ * Every move only changes two cells: the new head goes in and the old tail
+ * comes out. applyMove() writes down exactly those changes in a MoveUndo
+ * record, and undoMove() puts them back, so a search can walk down a line of
+ * play and back up again without ever copying the game.
+ *
+ * The same two cells are all the free-at grid (enteredAt) needs: the head's
+ * cell gets the new move count, and nothing else changes. The Zobrist hash
+ * likewise only swaps the keys of those two cells and of the head.
+ */
+
+#include <string.h>
+#include "game.h"
+#include "profile.h"
+
+/* Helpers for the occupancy grid */
+static void setCell(Snake *snake, Point p) {
+    int cell = cellIndex(p);
+    snake->occupied[cell >> 6] |= 1ULL << (cell & 63);
+}
+
+static void clearCell(Snake *snake, Point p) {
+    int cell = cellIndex(p);
+    snake->occupied[cell >> 6] &= ~(1ULL << (cell & 63));
+}
+
+/* Zobrist hash of the covered cells and the head, from scratch (for code
+ * that builds a snake without moving it there) */
+uint64_t computeSnakeHash(const Snake *snake) {
+    uint64_t hash = zobristKey(ZOBRIST_HEAD, cellIndex(snakeSegment(snake, 0)));
+
+    for (int cell = 0; cell < CELL_COUNT; cell++) {
+        if ((snake->occupied[cell >> 6] >> (cell & 63)) & 1) {
+            hash ^= zobristKey(ZOBRIST_BODY, cell);
+        }
+    }
+    return hash;
+}
+
+/* The state hash computed from scratch, to check the one kept by the moves */
+uint64_t computeGameHash(const Game *game) {
+    Game copy = *game;
+    copy.snake.hash = computeSnakeHash(&game->snake);
+    return gameHash(&copy);
+}
+
+/* Smallest power of two that can hold 'segments' segments */
+static int ringCapacity(int segments) {
+    int capacity = BODY_MIN_CAPACITY;
+    while (capacity < segments) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+/* Initialize the game state, taking the body storage from the arena */
+bool initializeGame(Game *game, Arena *arena, uint64_t seed) {
+    Snake *snake = &game->snake;
+
+    game->arena = arena;
+    snake->body = arenaAlloc(arena, BODY_MIN_CAPACITY * sizeof(Point));
+    snake->occupied = arenaAlloc(arena, GRID_WORDS * sizeof(uint64_t));
+    snake->enteredAt = arenaAlloc(arena, CELL_COUNT * sizeof(int));
+    if (snake->body == NULL || snake->occupied == NULL || snake->enteredAt == NULL) {
+        return false;
+    }
+    snake->capacity = BODY_MIN_CAPACITY;
+    snake->head = 0;
+    snake->bitten = false;
+    memset(snake->occupied, 0, GRID_WORDS * sizeof(uint64_t));
+
+    /* Set initial snake position in the middle of the board */
+    int startX = WIDTH / 2;
+    int startY = HEIGHT / 2;
+
+    /* Set initial snake properties */
+    snake->size = INITIAL_SIZE;
+    snake->direction = RIGHT;
+    snake->heading = RIGHT;
+    snake->moves = INITIAL_SIZE - 1;
+
+    /* Create initial snake body segments */
+    for (int i = 0; i < snake->size; i++) {
+        snake->body[i].x = startX - i;
+        snake->body[i].y = startY;
+        setCell(snake, snake->body[i]);
+        snake->enteredAt[cellIndex(snake->body[i])] = snake->moves - i;
+    }
+    snake->hash = computeSnakeHash(snake);
+
+    /* A zero state would make the generator return zeros forever */
+    game->rng = seed ? seed : 0x9E3779B97F4A7C15ULL;
+    game->gameOver = false;
+    game->won = false;
+    memset(&game->stats, 0, sizeof(GameStats));
+    game->stats.minArea = 1.0f;
+    game->profiler = NULL;
+
+    /* Place the first food item */
+    placeFood(game);
+    return true;
+}
+
+/* Return a 32-bit random number and advance the state (xorshift64*) */
+uint32_t gameRandom(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return (uint32_t)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/* Return a uniformly random number below 'bound' (Lemire's method: one
+ * multiply, and a retry only for the few values that would bias the result) */
+uint32_t gameRandomBelow(uint64_t *state, uint32_t bound) {
+    uint64_t product = (uint64_t)gameRandom(state) * bound;
+    uint32_t low = (uint32_t)product;
+
+    if (low < bound) {
+        uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            product = (uint64_t)gameRandom(state) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return (uint32_t)(product >> 32);
+}
+
+/* Work out where a point ends up after one step in a direction */
+Point movePoint(Point p, int direction) {
+    /* Calculate new position based on direction */
+    switch (direction) {
+        case UP:
+            p.y--;
+            break;
+        case RIGHT:
+            p.x++;
+            break;
+        case DOWN:
+            p.y++;
+            break;
+        case LEFT:
+            p.x--;
+            break;
+    }
+
+    /* Implement tunneling/wrap-around behavior when snake hits walls */
+    /* If snake goes off the left edge, appear on the right edge */
+    if (p.x <= 0) {
+        p.x = WIDTH - 2; // -2 to account for the border
+    }
+    /* If snake goes off the right edge, appear on the left edge */
+    else if (p.x >= WIDTH - 1) {
+        p.x = 1; // 1 to account for the border
+    }
+    /* If snake goes off the top edge, appear on the bottom edge */
+    if (p.y <= 0) {
+        p.y = HEIGHT - 2; // -2 to account for the border
+    }
+    /* If snake goes off the bottom edge, appear on the top edge */
+    else if (p.y >= HEIGHT - 1) {
+        p.y = 1; // 1 to account for the border
+    }
+
+    return p;
+}
+
+/* Work out where the head would end up after one step in a direction */
+Point nextHead(const Snake *snake, int direction) {
+    return movePoint(snakeSegment(snake, 0), direction);
+}
+
+/* True if the tail cell is still covered once the tail segment leaves it.
+ * Right after eating, the last two segments share a cell. */
+static bool tailIsDoubled(const Snake *snake) {
+    if (snake->size < 2) {
+        return false;
+    }
+    Point tail = snakeSegment(snake, snake->size - 1);
+    Point before = snakeSegment(snake, snake->size - 2);
+    return tail.x == before.x && tail.y == before.y;
+}
+
+/* Move the snake one step in its current direction */
+void moveSnake(Snake *snake) {
+    Point head = nextHead(snake, snake->direction);
+    Point tail = snakeSegment(snake, snake->size - 1);
+
+    /* The tail leaves its cell first (unless another segment is still there) */
+    if (!tailIsDoubled(snake)) {
+        clearCell(snake, tail);
+        snake->hash ^= zobristKey(ZOBRIST_BODY, cellIndex(tail));
+    }
+
+    /* Then the head enters its new cell; if it is covered, the snake bit itself */
+    snake->bitten = isOccupied(snake, head);
+    setCell(snake, head);
+    if (!snake->bitten) {
+        snake->hash ^= zobristKey(ZOBRIST_BODY, cellIndex(head));
+    }
+    snake->hash ^= zobristKey(ZOBRIST_HEAD, cellIndex(snakeSegment(snake, 0))) ^
+                   zobristKey(ZOBRIST_HEAD, cellIndex(head));
+    snake->moves++;
+    snake->heading = snake->direction;
+    snake->enteredAt[cellIndex(head)] = snake->moves;
+
+    /* Step the ring back by one: the new head takes the old tail's place */
+    snake->head = (snake->head - 1) & (snake->capacity - 1);
+    snake->body[snake->head] = head;
+}
+
+/* Check if the snake has collided with itself */
+bool checkCollision(const Snake *snake) {
+    /* Only check for collision with own body (walls tunnel instead).
+     * moveSnake() already noticed whether the head landed on the body. */
+    return snake->bitten;
+}
+
+/* Number of board cells the body does not cover. Kept in O(1): the body
+ * covers one cell per segment, except that a freshly grown tail shares its
+ * cell with the segment before it. */
+int freeCells(const Snake *snake) {
+    return PLAY_CELLS - snake->size + (tailIsDoubled(snake) ? 1 : 0);
+}
+
+/* Number of covered cells among 'count' cells starting at grid bit 'start' */
+static int countCovered(const uint64_t *occupied, int start, int count) {
+    int covered = 0;
+
+    while (count > 0) {
+        int bit = start & 63;
+        int take = 64 - bit < count ? 64 - bit : count;
+        uint64_t word = occupied[start >> 6] >> bit;
+        if (take < 64) {
+            word &= (1ULL << take) - 1;
+        }
+        covered += __builtin_popcountll(word);
+        start += take;
+        count -= take;
+    }
+    return covered;
+}
+
+/* Place food on a uniformly random empty cell.
+ * Returns false (and leaves the food alone) if there is no empty cell.
+ *
+ * While the board is mostly empty, a few random probes almost always land
+ * on a free cell, which takes O(1). Otherwise the free cells of each row
+ * are counted with popcounts on the occupancy grid, and the k-th free cell
+ * is picked: O(HEIGHT) words instead of a scan over every cell. Either way
+ * every free cell is equally likely, since gameRandomBelow() has no modulo
+ * bias (snake-fuzz --placement checks this). */
+bool placeFood(Game *game) {
+    const Snake *snake = &game->snake;
+    int rowFree[HEIGHT];
+    int emptyCount = 0;
+
+    for (int probe = 0; probe < 4; probe++) {
+        uint32_t cell = gameRandomBelow(&game->rng, PLAY_CELLS);
+        Point p = { 1 + (int)(cell % (WIDTH - 2)), 1 + (int)(cell / (WIDTH - 2)) };
+        if (!isOccupied(snake, p)) {
+            game->food = p;
+            return true;
+        }
+    }
+
+    /* Count the free cells in every row */
+    for (int y = 1; y < HEIGHT - 1; y++) {
+        rowFree[y] = (WIDTH - 2) - countCovered(snake->occupied, y * WIDTH + 1, WIDTH - 2);
+        emptyCount += rowFree[y];
+    }
+    if (emptyCount == 0) {
+        return false;
+    }
+
+    /* Walk to the row holding the chosen free cell, then along it */
+    int index = (int)gameRandomBelow(&game->rng, (uint32_t)emptyCount);
+    int y = 1;
+    while (index >= rowFree[y]) {
+        index -= rowFree[y];
+        y++;
+    }
+    for (int x = 1; x < WIDTH - 1; x++) {
+        Point p = { x, y };
+        if (!isOccupied(snake, p) && index-- == 0) {
+            game->food = p;
+            break;
+        }
+    }
+    return true;
+}
+
+/* Make room for one more segment, moving the body to a bigger arena block */
+static bool growBody(Game *game) {
+    Snake *snake = &game->snake;
+    int capacity = snake->capacity * 2;
+
+    if (snake->size < snake->capacity) {
+        return true;
+    }
+
+    Point *body = arenaAlloc(game->arena, capacity * sizeof(Point));
+    if (body == NULL) {
+        return false;
+    }
+
+    /* Unroll the ring so the head starts at index 0 again */
+    for (int i = 0; i < snake->size; i++) {
+        body[i] = snakeSegment(snake, i);
+    }
+    snake->body = body;
+    snake->capacity = capacity;
+    snake->head = 0;
+    return true;
+}
+
+/* Check if the snake has eaten the food */
+bool eatFood(Snake *snake, const Point *food) {
+    /* Get head position */
+    Point head = snakeSegment(snake, 0);
+
+    /* Check if head is at the food position */
+    if (head.x == food->x && head.y == food->y) {
+        /* Increase snake size by duplicating the last segment */
+        Point tail = snakeSegment(snake, snake->size - 1);
+        snake->body[(snake->head + snake->size) & (snake->capacity - 1)] = tail;
+        snake->size++;
+        return true;
+    }
+
+    return false;
+}
+
+/* Change direction, ignoring requests to reverse straight into the body.
+ * The check is against the last move, so several turns before one tick
+ * cannot add up to a reversal. */
+bool turnSnake(Snake *snake, int direction) {
+    if (direction == OPPOSITE(snake->heading)) {
+        return false;
+    }
+    snake->direction = direction;
+    return true;
+}
+
+/* Turn (if allowed) and advance one tick, recording how to undo it.
+ * Returns true if food was eaten. */
+bool applyMove(Game *game, int direction, MoveUndo *undo) {
+    Snake *snake = &game->snake;
+
+    /* Save everything the move can overwrite */
+    undo->tail = snakeSegment(snake, snake->size - 1);
+    undo->food = game->food;
+    undo->rng = game->rng;
+    undo->direction = snake->direction;
+    undo->heading = snake->heading;
+    undo->gameOver = game->gameOver;
+    undo->won = game->won;
+    undo->moved = false;
+    undo->ate = false;
+
+    turnSnake(snake, direction);
+    Point head = nextHead(snake, snake->direction);
+
+    /* Eating needs one more body slot; a simulation whose arena has run dry
+     * simply stops here instead of writing past the end of the body */
+    if (head.x == game->food.x && head.y == game->food.y && !growBody(game)) {
+        game->gameOver = true;
+        return false;
+    }
+
+    undo->tailCleared = !tailIsDoubled(snake);
+    undo->headEnteredAt = snake->enteredAt[cellIndex(head)];
+    undo->hash = snake->hash;
+    PROFILE_BEGIN(game, PHASE_MOVE);
+    moveSnake(snake);
+    PROFILE_END(game);
+    undo->headWasSet = snake->bitten;
+    undo->moved = true;
+
+    /* Check if the snake ate food */
+    undo->ate = eatFood(snake, &game->food);
+    if (undo->ate) {
+        /* Eating the last free cell fills the board and wins the game;
+         * otherwise place new food */
+        if (freeCells(snake) == 0) {
+            game->won = true;
+            game->gameOver = true;
+            return true;
+        }
+        PROFILE_BEGIN(game, PHASE_FOOD);
+        placeFood(game);
+        PROFILE_END(game);
+    }
+
+    /* Check for collisions with self */
+    PROFILE_BEGIN(game, PHASE_COLLISION);
+    bool bitten = checkCollision(snake);
+    PROFILE_END(game);
+    if (bitten) {
+        game->gameOver = true;
+    }
+
+    return undo->ate;
+}
+
+/* Take back a move made by applyMove(); moves must be undone newest first */
+void undoMove(Game *game, const MoveUndo *undo) {
+    Snake *snake = &game->snake;
+
+    if (undo->moved) {
+        /* Drop the segment added by eating */
+        if (undo->ate) {
+            snake->size--;
+        }
+
+        /* Take the head out of its cell, then step the ring forward again.
+         * The cell may belong to the tail or the bitten segment once more. */
+        Point head = snakeSegment(snake, 0);
+        if (!undo->headWasSet) {
+            clearCell(snake, head);
+        }
+        snake->enteredAt[cellIndex(head)] = undo->headEnteredAt;
+        snake->moves--;
+        snake->hash = undo->hash;
+        snake->head = (snake->head + 1) & (snake->capacity - 1);
+
+        /* Put the tail back in case the head's slot overwrote it */
+        snake->body[(snake->head + snake->size - 1) & (snake->capacity - 1)] =
+            undo->tail;
+        if (undo->tailCleared) {
+            setCell(snake, undo->tail);
+        }
+    }
+
+    snake->direction = undo->direction;
+    snake->heading = undo->heading;
+    snake->bitten = false;
+    game->food = undo->food;
+    game->rng = undo->rng;
+    game->gameOver = undo->gameOver;
+    game->won = undo->won;
+}
+
+/* Count the free cells reachable from 'start' (flood fill), where 'tail' is
+ * treated as free because it moves out of the way this tick. 'start' itself
+ * is counted even if the body covers it. */
+int reachableArea(const Snake *snake, Point start, Point tail) {
+    uint64_t seen[GRID_WORDS];
+    int queue[CELL_COUNT];
+    int head = 0;
+    int count = 0;
+
+    /* Covered cells count as already seen, so the fill never enters them */
+    memcpy(seen, snake->occupied, sizeof(seen));
+    int tailCell = cellIndex(tail);
+    seen[tailCell >> 6] &= ~(1ULL << (tailCell & 63));
+
+    int startCell = cellIndex(start);
+    seen[startCell >> 6] |= 1ULL << (startCell & 63);
+    queue[count++] = startCell;
+
+    while (head < count) {
+        Point p = { queue[head] % WIDTH, queue[head] / WIDTH };
+        head++;
+
+        for (int dir = 0; dir < 4; dir++) {
+            int cell = cellIndex(movePoint(p, dir));
+            if (!((seen[cell >> 6] >> (cell & 63)) & 1)) {
+                seen[cell >> 6] |= 1ULL << (cell & 63);
+                queue[count++] = cell;
+            }
+        }
+    }
+
+    return count;
+}
+
+/* Update the statistics after a move made by stepGame() */
+static void recordStats(Game *game, const MoveUndo *undo) {
+    GameStats *stats = &game->stats;
+    const Snake *snake = &game->snake;
+
+    /* Callers usually turn the snake before stepping, so the heading is
+     * compared with the last move's rather than with undo->direction */
+    stats->ticks++;
+    if (snake->heading != undo->heading) {
+        stats->turns++;
+    }
+    if (undo->ate) {
+        stats->food++;
+        stats->lastMeal = stats->ticks;
+    } else if (stats->ticks - stats->lastMeal > stats->longestHunger) {
+        stats->longestHunger = stats->ticks - stats->lastMeal;
+    }
+    if (game->gameOver) {
+        return;
+    }
+
+    /* A near miss: one of the next moves would bite. A tail that has just
+     * grown stays put for another tick, so it counts as body here. */
+    Point head = snakeSegment(snake, 0);
+    bool nearMiss = false;
+    for (int dir = 0; dir < 4 && !nearMiss; dir++) {
+        if (dir != OPPOSITE(snake->direction) && !cellSafeAt(snake, movePoint(head, dir), 1)) {
+            nearMiss = true;
+        }
+    }
+    if (!nearMiss) {
+        return;
+    }
+    stats->nearMisses++;
+    if (!stats->measureArea) {
+        return;
+    }
+
+    /* The fill starts at the head, which it counts. A tail that moves away
+     * this tick is counted as free there, so it is added to the free cells
+     * here too; a doubled one is not (passing the head leaves it covered). */
+    Point tail = snakeSegment(snake, snake->size - 1);
+    bool tailMoves = cellSafeAt(snake, tail, 1);
+    float area = (float)(reachableArea(snake, head, tailMoves ? tail : head) - 1) /
+                 (freeCells(snake) + tailMoves);
+    if (area < stats->minArea) {
+        stats->minArea = area;
+    }
+}
+
+/* Advance the game by one tick; returns true if food was eaten */
+bool stepGame(Game *game) {
+    MoveUndo undo;
+    bool ate = applyMove(game, game->snake.direction, &undo);
+    if (undo.moved) {
+        recordStats(game, &undo);
+    }
+    return ate;
+}
+
+/* Write the statistics of a finished game as one JSON line, so batch runs can
+ * append to a file and aggregate it later. 'tickSeconds' is the length of a
+ * tick, for the food-per-minute rate. */
+void writeGameStats(FILE *out, const Game *game, double tickSeconds,
+                    const char *player, uint64_t seed) {
+    const GameStats *stats = &game->stats;
+    double minutes = stats->ticks * tickSeconds / 60.0;
+    int hunger = stats->ticks - stats->lastMeal;
+    char areaDip[16] = "null";
+
+    if (stats->measureArea) {
+        snprintf(areaDip, sizeof(areaDip), "%.3f", 1.0 - stats->minArea);
+    }
+    if (hunger < stats->longestHunger) {
+        hunger = stats->longestHunger;
+    }
+    fprintf(out, "{\"player\":\"%s\",\"seed\":%llu,\"score\":%d,\"won\":%s,"
+            "\"ticks\":%d,\"food\":%d,\"food_per_minute\":%.2f,"
+            "\"ticks_per_food\":%.2f,\"turns\":%d,\"near_misses\":%d,"
+            "\"longest_hunger\":%d,\"area_dip\":%s}\n",
+            player, (unsigned long long)seed, game->snake.size - INITIAL_SIZE,
+            game->won ? "true" : "false", stats->ticks, stats->food,
+            minutes > 0 ? stats->food / minutes : 0.0,
+            stats->food > 0 ? (double)stats->ticks / stats->food : 0.0,
+            stats->turns, stats->nearMisses, hunger, areaDip);
+}
+
+/* Clone a game into an arena, with room for 'headroom' more segments.
+ * Only the live part of the body and the occupancy bits are copied, and
+ * nothing is malloc'd. Likewise only the free-at entries of covered cells
+ * are copied, since the others mean nothing. */
+Game *cloneGame(Arena *arena, const Game *src, int headroom) {
+    int capacity = ringCapacity(src->snake.size + headroom);
+
+    Game *dst = arenaAlloc(arena, sizeof(Game));
+    Point *body = arenaAlloc(arena, capacity * sizeof(Point));
+    uint64_t *occupied = arenaAlloc(arena, GRID_WORDS * sizeof(uint64_t));
+    int *enteredAt = arenaAlloc(arena, CELL_COUNT * sizeof(int));
+    if (dst == NULL || body == NULL || occupied == NULL || enteredAt == NULL) {
+        return NULL;
+    }
+
+    *dst = *src;
+    dst->arena = arena;
+    dst->profiler = NULL;
+    dst->snake.body = body;
+    dst->snake.capacity = capacity;
+    dst->snake.head = 0;
+    dst->snake.occupied = occupied;
+    dst->snake.enteredAt = enteredAt;
+    for (int i = 0; i < src->snake.size; i++) {
+        body[i] = snakeSegment(&src->snake, i);
+        enteredAt[cellIndex(body[i])] = src->snake.enteredAt[cellIndex(body[i])];
+    }
+    memcpy(occupied, src->snake.occupied, GRID_WORDS * sizeof(uint64_t));
+    return dst;
+}
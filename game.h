@@ -0,0 +1,211 @@
+/**
+ * Snake Game - Headless Core
+ *
+ * This header describes the game rules without any terminal code, so the same
+ * logic can drive the interactive game, AI rollouts and batch simulations.
+ * Every function here only touches the state it is given, which means several
+ * threads can simulate separate games at the same time.
+ */
+
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "arena.h"
+
+/* Game Constants (board size can be overridden at compile time) */
+#ifndef WIDTH
+#define WIDTH 30      // Width of the game board
+#endif
+#ifndef HEIGHT
+#define HEIGHT 20     // Height of the game board
+#endif
+#define INITIAL_SIZE 3  // Initial size of the snake
+#define CELL_COUNT (WIDTH * HEIGHT)  // Number of cells including the border
+#define PLAY_CELLS ((WIDTH - 2) * (HEIGHT - 2))  // Cells inside the border
+#define GRID_WORDS ((CELL_COUNT + 63) / 64)  // 64-bit words in an occupancy grid
+#define BODY_MIN_CAPACITY 16         // Smallest body ring (always a power of 2)
+
+/* Direction Constants */
+#define UP 0
+#define RIGHT 1
+#define DOWN 2
+#define LEFT 3
+
+/* The direction pointing the opposite way (UP <-> DOWN, LEFT <-> RIGHT) */
+#define OPPOSITE(dir) (((dir) + 2) % 4)
+
+/* Structure to represent a point on the game board */
+typedef struct {
+    int x;
+    int y;
+} Point;
+
+/* Structure to represent the snake.
+ * The body is a ring buffer: moving adds a head in front and lets the tail
+ * drop off the back, so no segment is ever shifted. Use snakeSegment() to
+ * read segment i (0 = head). The occupancy grid has one bit per board cell
+ * that is set while any segment covers it.
+ *
+ * The tail leaves cells in the order the head entered them, so each covered
+ * cell frees up at a known tick. enteredAt holds the move count at which the
+ * head last entered each cell: segment i entered moves - i, and leaves the
+ * cell size - i moves from now. Moving writes one entry and eating writes
+ * none (the larger size delays every cell at once), so it costs O(1) per
+ * tick. Entries of cells the body does not cover mean nothing.
+ *
+ * hash is the Zobrist hash of the covered cells and the head cell: one
+ * random key per cell and kind, XORed together. A move changes at most
+ * three keys, so moveSnake() keeps it up to date in O(1); gameHash() adds
+ * the direction, size and food when it is read. */
+typedef struct {
+    Point *body;         // Ring of segments, stored in the game's arena
+    int capacity;        // Ring size (a power of two)
+    int head;            // Ring index of the head
+    int size;            // Current size
+    int direction;       // Current direction (where the next move goes)
+    int heading;         // Direction of the last move
+    uint64_t *occupied;  // Occupancy grid, GRID_WORDS words
+    int *enteredAt;      // Move count when the head entered each cell, CELL_COUNT
+    int moves;           // Moves made (the first segments count as made)
+    uint64_t hash;       // Zobrist hash of the covered cells and the head
+    bool bitten;         // The last move put the head on a covered cell
+} Snake;
+
+/* Statistics kept by stepGame(). Each tick updates them in O(1). The area
+ * dip is opt-in: with measureArea set, the reachable area is flood filled on
+ * near-miss ticks, the only ones where the head runs alongside the body and
+ * can cut the free space in two. */
+typedef struct {
+    int ticks;           // Ticks survived
+    int food;            // Food eaten
+    int turns;           // Ticks on which the heading changed
+    int nearMisses;      // Ticks that ended one wrong turn away from a bite
+    int lastMeal;        // Tick of the last meal
+    int longestHunger;   // Most ticks without food
+    float minArea;       // Lowest share of the free cells the head could reach
+    bool measureArea;    // Set by the caller to track minArea (O(board) per near miss)
+} GameStats;
+
+/* Phase timing for the game being played (see profile.h) */
+struct TickProfiler;
+
+/* Structure holding everything needed to simulate one game */
+typedef struct {
+    Snake snake;        // The snake itself
+    Point food;         // Current food position
+    bool gameOver;      // Set once the snake hits itself or fills the board
+    bool won;           // The snake filled the board (gameOver is set too)
+    uint64_t rng;       // Private random state, so games never share rand()
+    Arena *arena;       // Where the body grows into when it runs out of room
+    GameStats stats;    // Updated by stepGame() only, never by searches
+    struct TickProfiler *profiler;  // Measures the tick's phases, or NULL
+} Game;
+
+/* Everything needed to take back one move with undoMove() */
+typedef struct {
+    Point tail;          // Tail segment before the move (its slot may be reused)
+    Point food;          // Food position before the move
+    uint64_t rng;        // Random state before the move
+    int direction;       // Direction before the move
+    int heading;         // Heading before the move
+    bool moved;          // False if the move never happened (arena ran dry)
+    bool ate;            // The snake grew by one segment
+    bool headWasSet;     // The head entered a cell that was already covered
+    bool tailCleared;    // The tail's cell was cleared in the occupancy grid
+    int headEnteredAt;   // enteredAt of the head's new cell before the move
+    uint64_t hash;       // Snake hash before the move
+    bool gameOver;       // gameOver before the move
+    bool won;            // won before the move
+} MoveUndo;
+
+/* Arena bytes one game can use over its whole life (body doubling included) */
+#define GAME_ARENA_BYTES \
+    (sizeof(Game) + GRID_WORDS * sizeof(uint64_t) + CELL_COUNT * sizeof(int) + \
+     4 * CELL_COUNT * sizeof(Point) + 16 * ARENA_ALIGN)
+
+/* Index of a point in the occupancy grid */
+static inline int cellIndex(Point p) {
+    return p.y * WIDTH + p.x;
+}
+
+/* Segment i of the snake, counting from the head */
+static inline Point snakeSegment(const Snake *snake, int i) {
+    return snake->body[(snake->head + i) & (snake->capacity - 1)];
+}
+
+/* True if any part of the snake covers the point */
+static inline bool isOccupied(const Snake *snake, Point p) {
+    int cell = cellIndex(p);
+    return (snake->occupied[cell >> 6] >> (cell & 63)) & 1;
+}
+
+/* Kinds of Zobrist key */
+#define ZOBRIST_BODY      0  // A covered cell
+#define ZOBRIST_HEAD      1  // The head's cell
+#define ZOBRIST_FOOD      2  // The food's cell
+#define ZOBRIST_DIRECTION 3  // The direction the next move goes
+#define ZOBRIST_SIZE      4  // The snake's length
+
+/* The key for one feature of the state. Keys are a fixed hash of the kind
+ * and index (splitmix64), so every program and every machine agrees on
+ * them without a table. */
+static inline uint64_t zobristKey(int kind, int index) {
+    uint64_t z = ((uint64_t)kind * CELL_COUNT + (uint64_t)index + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* Hash of the whole game state: the cells the body covers, the head, the
+ * food, the direction and the length. The direction is the one the next
+ * move goes, which after every applyMove() is also the heading. The order of
+ * the body within its cells is not part of it. */
+static inline uint64_t gameHash(const Game *game) {
+    return game->snake.hash ^
+           zobristKey(ZOBRIST_FOOD, cellIndex(game->food)) ^
+           zobristKey(ZOBRIST_DIRECTION, game->snake.direction) ^
+           zobristKey(ZOBRIST_SIZE, game->snake.size);
+}
+
+/* Ticks until the body leaves the cell, or 0 if it is free now. Food eaten
+ * in the meantime holds the tail back one tick per meal. */
+static inline int cellFreeIn(const Snake *snake, Point p) {
+    if (!isOccupied(snake, p)) {
+        return 0;
+    }
+    return snake->enteredAt[cellIndex(p)] + snake->size - snake->moves;
+}
+
+/* True if the head can be on the cell 'ticks' moves from now (1 = the next
+ * move) without biting, as long as no food is eaten on the way */
+static inline bool cellSafeAt(const Snake *snake, Point p, int ticks) {
+    return cellFreeIn(snake, p) <= ticks;
+}
+
+/* Function prototypes */
+bool initializeGame(Game *game, Arena *arena, uint64_t seed);
+void moveSnake(Snake *snake);
+bool checkCollision(const Snake *snake);
+bool placeFood(Game *game);
+int freeCells(const Snake *snake);
+int reachableArea(const Snake *snake, Point start, Point tail);
+void writeGameStats(FILE *out, const Game *game, double tickSeconds,
+                    const char *player, uint64_t seed);
+bool eatFood(Snake *snake, const Point *food);
+bool turnSnake(Snake *snake, int direction);
+bool stepGame(Game *game);
+bool applyMove(Game *game, int direction, MoveUndo *undo);
+void undoMove(Game *game, const MoveUndo *undo);
+Game *cloneGame(Arena *arena, const Game *src, int headroom);
+Point movePoint(Point p, int direction);
+Point nextHead(const Snake *snake, int direction);
+uint64_t computeSnakeHash(const Snake *snake);
+uint64_t computeGameHash(const Game *game);
+uint32_t gameRandom(uint64_t *state);
+uint32_t gameRandomBelow(uint64_t *state, uint32_t bound);
+
+#endif /* GAME_H */
@@ -0,0 +1,320 @@
+/**
+ * Snake Game - Path Heatmap (snake-heatmap)
+ *
+ * Plays many headless games with one bot and counts how often the head
+ * visits each cell, and where the food appears. The result is drawn as a
+ * colored map in the terminal or written as a PGM image; a bot that favours
+ * one side of the board, or food that lands in some cells more than others,
+ * shows up at a glance.
+ *
+ * Every thread counts into its own grid, so the hot loop is a plain
+ * increment with no atomics or shared cache lines. The grids are added up
+ * once all games are done. Game seeds depend only on --seed and the game
+ * number, so the same seed gives the same map on any number of threads.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "game.h"
+#include "bots.h"
+#include "clock.h"
+
+/* Heatmap Limits */
+#define HEATMAP_MAX_THREADS 256
+
+/* Everything shared between the game threads */
+typedef struct {
+    const BotType *bot;
+    uint64_t seed;
+    int games;
+    int maxTicks;
+
+    pthread_mutex_t lock;
+    int nextGame;
+} Heatmap;
+
+/* One thread's counters; each lives in its own allocation */
+typedef struct {
+    Heatmap *heatmap;
+    uint64_t head[CELL_COUNT];   // Ticks the head spent on each cell
+    uint64_t food[CELL_COUNT];   // Food placements on each cell
+    long long ticks;
+} HeatThread;
+
+/* Function prototypes */
+void *heatThread(void *arg);
+void playGame(HeatThread *slot, uint64_t seed, Arena *arena);
+bool countTick(void *context, const Game *game, int tick, bool ate);
+void printHeatmap(const uint64_t *counts, const char *title);
+bool writePgm(const char *path, const uint64_t *counts, int scale);
+uint64_t maxCount(const uint64_t *counts);
+void usage(const char *program);
+
+/* Main function - entry point of the program */
+int main(int argc, char *argv[]) {
+    static Heatmap heatmap;
+    static uint64_t head[CELL_COUNT];
+    static uint64_t food[CELL_COUNT];
+    BotOptions botOptions = { NULL, NULL, 5, NULL, 10000, NULL, 1, NULL };
+    const char *botName = "heuristic";
+    const char *pgmFile = NULL;
+    bool showFood = false;
+    int scale = 16;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    heatmap.seed = (uint64_t)time(NULL);
+    heatmap.games = 1000;
+    heatmap.maxTicks = 5000;
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bot") == 0 && i + 1 < argc) {
+            botName = argv[++i];
+        } else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            heatmap.games = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            heatmap.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            heatmap.maxTicks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--food") == 0) {
+            showFood = true;
+        } else if (strcmp(argv[i], "--pgm") == 0 && i + 1 < argc) {
+            pgmFile = argv[++i];
+        } else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+            scale = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--weights") == 0 && i + 1 < argc) {
+            botOptions.weightsFile = argv[++i];
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            botOptions.policyFile = argv[++i];
+        } else if (strcmp(argv[i], "--mcts-ms") == 0 && i + 1 < argc) {
+            botOptions.mctsBudgetMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--plugin") == 0 && i + 1 < argc) {
+            botOptions.pluginFile = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (threads > HEATMAP_MAX_THREADS) threads = HEATMAP_MAX_THREADS;
+    if (scale < 1) scale = 1;
+
+    char error[256];
+    if (!configureBots(&botOptions, error, sizeof(error))) {
+        fprintf(stderr, "%s\n", error);
+        return 1;
+    }
+    heatmap.bot = findBot(botName);
+    if (heatmap.bot == NULL || !botAvailable(heatmap.bot)) {
+        fprintf(stderr, "Unknown or unavailable bot: %s\n", botName);
+        return 1;
+    }
+
+    /* Start the threads, each with its own counters */
+    HeatThread *slots[HEATMAP_MAX_THREADS];
+    pthread_t workers[HEATMAP_MAX_THREADS];
+    int started = 0;
+    pthread_mutex_init(&heatmap.lock, NULL);
+    double start = secondsNow();
+    for (int t = 0; t < threads; t++) {
+        slots[started] = calloc(1, sizeof(HeatThread));
+        if (slots[started] == NULL) {
+            break;
+        }
+        slots[started]->heatmap = &heatmap;
+        if (pthread_create(&workers[started], NULL, heatThread, slots[started]) != 0) {
+            free(slots[started]);
+            break;
+        }
+        started++;
+    }
+    if (started == 0) {
+        fprintf(stderr, "Could not start any threads\n");
+        return 1;
+    }
+
+    /* Add up the per-thread grids */
+    long long ticks = 0;
+    for (int t = 0; t < started; t++) {
+        pthread_join(workers[t], NULL);
+        for (int c = 0; c < CELL_COUNT; c++) {
+            head[c] += slots[t]->head[c];
+            food[c] += slots[t]->food[c];
+        }
+        ticks += slots[t]->ticks;
+        free(slots[t]);
+    }
+    double elapsed = secondsNow() - start;
+    pthread_mutex_destroy(&heatmap.lock);
+
+    printf("%s: %d games, %lld ticks on %d threads in %.1f s (seed %llu)\n",
+           heatmap.bot->name, heatmap.games, ticks, started, elapsed,
+           (unsigned long long)heatmap.seed);
+
+    const uint64_t *counts = showFood ? food : head;
+    if (pgmFile != NULL) {
+        if (!writePgm(pgmFile, counts, scale)) {
+            fprintf(stderr, "Could not write %s\n", pgmFile);
+            return 1;
+        }
+        printf("Wrote %s\n", pgmFile);
+    } else {
+        printHeatmap(counts, showFood ? "Food placements" : "Head visits");
+    }
+    return 0;
+}
+
+/* Game thread: take games from the queue until all are played */
+void *heatThread(void *arg) {
+    HeatThread *slot = arg;
+    Heatmap *heatmap = slot->heatmap;
+    Arena arena;
+
+    if (!arenaInit(&arena, GAME_ARENA_BYTES)) {
+        return NULL;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&heatmap->lock);
+        int next = heatmap->nextGame++;
+        pthread_mutex_unlock(&heatmap->lock);
+
+        if (next >= heatmap->games) {
+            break;
+        }
+        playGame(slot, heatmap->seed + (uint64_t)next * 0x9E3779B97F4A7C15ULL, &arena);
+    }
+
+    arenaFree(&arena);
+    return NULL;
+}
+
+/* Play one game, counting into the thread's own grids */
+void playGame(HeatThread *slot, uint64_t seed, Arena *arena) {
+    const BotType *type = slot->heatmap->bot;
+    void *state = type->create != NULL ? type->create(seed) : NULL;
+    PlayOptions options = { slot->heatmap->maxTicks, false, countTick, slot };
+    Game game;
+
+    slot->ticks += playBotGame(&game, arena, seed, type->chooseMove, state, &options);
+    if (type->destroy != NULL) {
+        type->destroy(state);
+    }
+}
+
+/* Count where the food appears and where the head goes */
+bool countTick(void *context, const Game *game, int tick, bool ate) {
+    HeatThread *slot = context;
+
+    if ((tick == 0 || ate) && !game->won) {
+        slot->food[cellIndex(game->food)]++;
+    }
+    if (tick > 0) {
+        slot->head[cellIndex(snakeSegment(&game->snake, 0))]++;
+    }
+    return true;
+}
+
+/* Draw the map with 256-color backgrounds, from dark blue (never) to red
+ * (most visited), followed by a few numbers on how even it is */
+void printHeatmap(const uint64_t *counts, const char *title) {
+    static const int ramp[] = {
+        17, 18, 19, 20, 21, 27, 33, 39, 45, 51, 50, 49, 48, 47, 46,
+        82, 118, 154, 190, 226, 220, 214, 208, 202, 196
+    };
+    const int steps = (int)(sizeof(ramp) / sizeof(ramp[0]));
+    uint64_t most = maxCount(counts);
+    uint64_t least = most;
+    uint64_t total = 0;
+
+    printf("%s\n", title);
+    for (int y = 1; y < HEIGHT - 1; y++) {
+        for (int x = 1; x < WIDTH - 1; x++) {
+            Point p = { x, y };
+            uint64_t count = counts[cellIndex(p)];
+            int level = most > 0 ? (int)(count * (steps - 1) / most) : 0;
+            printf("\033[48;5;%dm  ", ramp[level]);
+            total += count;
+            if (count < least) {
+                least = count;
+            }
+        }
+        printf("\033[0m\n");
+    }
+
+    double mean = (double)total / PLAY_CELLS;
+    printf("min %llu, mean %.1f, max %llu (max/mean %.2f)\n",
+           (unsigned long long)least, mean, (unsigned long long)most,
+           mean > 0 ? most / mean : 0.0);
+}
+
+/* Write the map as a binary greyscale PGM, 'scale' pixels per cell */
+bool writePgm(const char *path, const uint64_t *counts, int scale) {
+    uint64_t most = maxCount(counts);
+    int width = (WIDTH - 2) * scale;
+    FILE *file = fopen(path, "wb");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, "P5\n%d %d\n255\n", width, (HEIGHT - 2) * scale);
+    unsigned char *row = malloc(width);
+    if (row == NULL) {
+        fclose(file);
+        return false;
+    }
+    for (int y = 1; y < HEIGHT - 1; y++) {
+        for (int x = 1; x < WIDTH - 1; x++) {
+            Point p = { x, y };
+            uint64_t count = counts[cellIndex(p)];
+            unsigned char shade = most > 0 ? (unsigned char)(count * 255 / most) : 0;
+            memset(row + (x - 1) * scale, shade, scale);
+        }
+        for (int i = 0; i < scale; i++) {
+            fwrite(row, 1, width, file);
+        }
+    }
+    free(row);
+    return fclose(file) == 0;
+}
+
+/* Largest count on the board */
+uint64_t maxCount(const uint64_t *counts) {
+    uint64_t most = 0;
+    for (int c = 0; c < CELL_COUNT; c++) {
+        if (counts[c] > most) {
+            most = counts[c];
+        }
+    }
+    return most;
+}
+
+/* Print command line help */
+void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --bot NAME        Bot to watch (default heuristic)\n");
+    fprintf(stderr, "  --games N         Games to play (default 1000)\n");
+    fprintf(stderr, "  --threads N       Worker threads (default: one per CPU)\n");
+    fprintf(stderr, "  --seed N          Seed for the game seeds (default: clock)\n");
+    fprintf(stderr, "  --max-ticks N     Tick limit per game (default 5000)\n");
+    fprintf(stderr, "  --food            Map food placements instead of head visits\n");
+    fprintf(stderr, "  --pgm FILE        Write a PGM image instead of drawing the map\n");
+    fprintf(stderr, "  --scale N         PGM pixels per cell (default 16)\n");
+    fprintf(stderr, "  --weights FILE    Heuristic bot weights\n");
+    fprintf(stderr, "  --policy FILE     Policy bot network\n");
+    fprintf(stderr, "  --mcts-ms N       MCTS bot thinking time per move (default 5)\n");
+    fprintf(stderr, "  --plugin FILE     Plugin bot shared library\n");
+    fprintf(stderr, "Bots:\n");
+    for (int i = 0; i < botCount(); i++) {
+        fprintf(stderr, "  %-10s %s\n", botAt(i)->name, botAt(i)->description);
+    }
+}
@@ -0,0 +1,134 @@
+/**
+ * Snake Game - Terminal Input and Tick Timer
+ *
+ * See input.h. Arrow keys arrive as ESC [ A (normal cursor mode) or ESC O A
+ * (the application mode curses switches on with keypad()). A sequence cut
+ * off at the end of one read is kept and finished by the next; anything
+ * else that starts with ESC is dropped, since the game has no use for it.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include "input.h"
+
+#define ESC 0x1b
+
+/* Put the terminal into non-blocking mode */
+bool openInput(InputReader *input, int fd) {
+    memset(input, 0, sizeof(InputReader));
+    input->fd = fd;
+    input->savedFlags = fcntl(fd, F_GETFL);
+    if (input->savedFlags < 0 || fcntl(fd, F_SETFL, input->savedFlags | O_NONBLOCK) < 0) {
+        return false;
+    }
+    return true;
+}
+
+/* Decode one key from the start of the bytes. Returns the bytes used, or 0
+ * if the bytes are the unfinished start of an escape sequence. */
+static int decodeKey(const unsigned char *bytes, int length, int *key) {
+    if (bytes[0] != ESC) {
+        *key = bytes[0];
+        return 1;
+    }
+    if (length < 3) {
+        /* ESC or ESC [ alone: wait for the rest unless it cannot be an arrow */
+        if (length == 2 && bytes[1] != '[' && bytes[1] != 'O') {
+            *key = -1;
+            return 1;
+        }
+        return 0;
+    }
+    if (bytes[1] != '[' && bytes[1] != 'O') {
+        *key = -1;
+        return 1;
+    }
+    switch (bytes[2]) {
+        case 'A': *key = INPUT_KEY_UP; break;
+        case 'B': *key = INPUT_KEY_DOWN; break;
+        case 'C': *key = INPUT_KEY_RIGHT; break;
+        case 'D': *key = INPUT_KEY_LEFT; break;
+        default: *key = -1; break;  // Some other sequence: skip its introducer
+    }
+    return 3;
+}
+
+/* Read whatever the terminal has and decode it into keys. Returns the number
+ * of keys, 0 if nothing was waiting, or -1 once the terminal has closed. */
+int readInput(InputReader *input, int *keys, int maxKeys) {
+    unsigned char bytes[INPUT_MAX_PENDING + 64];
+    int length = input->pendingLength;
+    int count = 0;
+
+    memcpy(bytes, input->pending, length);
+    ssize_t got = read(input->fd, bytes + length, sizeof(bytes) - length);
+    if (got == 0) {
+        return -1;
+    }
+    if (got < 0) {
+        return errno == EAGAIN || errno == EINTR ? 0 : -1;
+    }
+    length += got;
+
+    int at = 0;
+    while (at < length && count < maxKeys) {
+        int key;
+        int used = decodeKey(bytes + at, length - at, &key);
+        if (used == 0) {
+            break;
+        }
+        if (key >= 0) {
+            keys[count++] = key;
+        }
+        at += used;
+    }
+
+    /* Keep an unfinished sequence; bytes beyond maxKeys are dropped */
+    input->pendingLength = 0;
+    if (at < length && count < maxKeys && length - at <= INPUT_MAX_PENDING) {
+        memcpy(input->pending, bytes + at, length - at);
+        input->pendingLength = length - at;
+    }
+    return count;
+}
+
+/* Give the terminal back its blocking mode */
+void closeInput(InputReader *input) {
+    if (input->savedFlags >= 0) {
+        fcntl(input->fd, F_SETFL, input->savedFlags);
+    }
+}
+
+/* A timer that fires every periodMs, starting one period from now. The
+ * expiry times are fixed multiples of the period, so late reads never
+ * push the next tick back. */
+int openTickTimer(int periodMs) {
+    int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerFd < 0) {
+        return -1;
+    }
+    struct itimerspec period;
+    period.it_interval.tv_sec = periodMs / 1000;
+    period.it_interval.tv_nsec = (long)(periodMs % 1000) * 1000000L;
+    period.it_value = period.it_interval;
+    if (timerfd_settime(timerFd, 0, &period, NULL) != 0) {
+        close(timerFd);
+        return -1;
+    }
+    return timerFd;
+}
+
+/* Ticks that have passed since the last read (0 if none) */
+uint64_t readTickTimer(int timerFd) {
+    uint64_t expirations = 0;
+    if (read(timerFd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return 0;
+    }
+    return expirations;
+}
@@ -0,0 +1,44 @@
+/**
+ * Snake Game - Terminal Input and Tick Timer
+ *
+ * Reading keys and keeping time are two separate jobs, so they get two
+ * separate file descriptors that one poll() waits on: the terminal, read in
+ * non-blocking mode with the arrow-key escape sequences decoded here, and a
+ * timerfd that fires once per tick. A key is handled the moment it arrives,
+ * and the ticks follow the timer's fixed schedule, which does not drift
+ * however long a tick's work takes.
+ *
+ * The terminal must already be in cbreak/noecho mode (curses sets that up);
+ * this layer only reads from it.
+ */
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Codes for keys that are not plain characters (above any byte value) */
+#define INPUT_KEY_UP    0x101
+#define INPUT_KEY_DOWN  0x102
+#define INPUT_KEY_RIGHT 0x103
+#define INPUT_KEY_LEFT  0x104
+
+#define INPUT_MAX_PENDING 8  // Longest escape sequence kept between reads
+
+/* Terminal reader state */
+typedef struct {
+    int fd;                                   // Usually STDIN_FILENO
+    int savedFlags;                           // File status flags to restore
+    unsigned char pending[INPUT_MAX_PENDING]; // Start of an unfinished sequence
+    int pendingLength;
+} InputReader;
+
+/* Function prototypes */
+bool openInput(InputReader *input, int fd);
+int readInput(InputReader *input, int *keys, int maxKeys);
+void closeInput(InputReader *input);
+int openTickTimer(int periodMs);
+uint64_t readTickTimer(int timerFd);
+
+#endif /* INPUT_H */
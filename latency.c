@@ -0,0 +1,68 @@
+/**
+ * Snake Game - Input Latency Log
+ *
+ * See latency.h. Stamping is a clock read and a store, so the log can stay
+ * on for a whole game without changing what it measures.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "latency.h"
+#include "clock.h"
+
+/* A key that changes the heading has just been read. Several keys before
+ * the next step all show up in the same frame, so the oldest one counts. */
+void latencyKey(LatencyLog *log) {
+    if (log->pendingNs == 0) {
+        log->pendingNs = nowNs();
+    }
+}
+
+/* The snake has moved, taking the pending keys with it */
+void latencyApplied(LatencyLog *log) {
+    if (log->pendingNs != 0 && log->appliedNs == 0) {
+        log->appliedNs = log->pendingNs;
+    }
+    log->pendingNs = 0;
+}
+
+/* A frame has been flushed to the terminal */
+void latencyFlushed(LatencyLog *log) {
+    if (log->appliedNs == 0) {
+        return;
+    }
+    if (log->count < LATENCY_MAX_SAMPLES) {
+        log->samples[log->count++] = nowNs() - log->appliedNs;
+    } else {
+        log->dropped++;
+    }
+    log->appliedNs = 0;
+}
+
+static int compareSamples(const void *a, const void *b) {
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+/* Print the distribution in microseconds (sorts the samples) */
+void printLatency(const char *title, long long *samples, int count, FILE *out) {
+    if (count == 0) {
+        fprintf(out, "%s: no samples\n", title);
+        return;
+    }
+    qsort(samples, count, sizeof(long long), compareSamples);
+
+    double total = 0;
+    for (int i = 0; i < count; i++) {
+        total += samples[i];
+    }
+    fprintf(out, "%s: %d samples, mean %.1f us\n", title, count, total / count / 1e3);
+    fprintf(out, "  min %.1f  p50 %.1f  p90 %.1f  p99 %.1f  max %.1f us\n",
+            samples[0] / 1e3, samples[count / 2] / 1e3,
+            samples[(int)(count * 0.9)] / 1e3, samples[(int)(count * 0.99)] / 1e3,
+            samples[count - 1] / 1e3);
+}
@@ -0,0 +1,39 @@
+/**
+ * Snake Game - Input Latency Log
+ *
+ * Measures how long a keypress takes to reach the screen. A key is stamped
+ * the moment it is read; the step that moves the snake in the new direction
+ * marks it applied, and once the frame drawn after that step has been
+ * flushed to the terminal the time since the key is recorded. Only keys
+ * that actually change the heading are counted, since any other key leaves
+ * the picture unchanged.
+ *
+ * snake --latency keeps the log and prints the distribution at the end;
+ * snake-latency (latencyharness.c) measures the same thing from outside,
+ * through a pseudo-terminal, with no human at the keyboard.
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#define LATENCY_MAX_SAMPLES 4096  // Samples kept; later ones are only counted
+
+/* Keys on their way to the screen */
+typedef struct {
+    long long pendingNs;   // Read time of the oldest key not yet applied, 0 if none
+    long long appliedNs;   // Read time of the oldest key applied but not yet drawn
+    long long samples[LATENCY_MAX_SAMPLES];  // Latencies in nanoseconds
+    int count;
+    long dropped;          // Samples that did not fit
+} LatencyLog;
+
+/* Function prototypes */
+void latencyKey(LatencyLog *log);
+void latencyApplied(LatencyLog *log);
+void latencyFlushed(LatencyLog *log);
+void printLatency(const char *title, long long *samples, int count, FILE *out);
+
+#endif /* LATENCY_H */
@@ -0,0 +1,225 @@
+/**
+ * Snake Game - Keypress Latency Harness (snake-latency)
+ *
+ * Runs the game in a pseudo-terminal, types turns into it and measures how
+ * long each one takes to come back out as a frame, end to end and with no
+ * human involved. The game is started with --latency, which makes its
+ * status line show the heading; ncurses redraws the whole screen every
+ * frame, so the first "Heading: UP" read back after typing 'w' is the first
+ * frame that reflects the key.
+ *
+ * The turns zig-zag (up, right, down, right, ...) so the snake never runs
+ * into itself. At the end the game's own measurement (key read to frame
+ * flushed) is shown next to the harness's, so the cost of the terminal
+ * path can be read off the difference.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "latency.h"
+#include "game.h"
+#include "clock.h"
+
+#define MAX_KEYS LATENCY_MAX_SAMPLES
+
+/* Keys and status line names of the four headings */
+static const char headingKeys[] = { 'w', 'd', 's', 'a' };
+static const char *headingNames[] = { "UP", "RIGHT", "DOWN", "LEFT" };
+
+/* The zig-zag of turns, starting from the initial heading RIGHT */
+static const int turnPattern[] = { UP, RIGHT, DOWN, RIGHT };
+
+/* Function prototypes */
+long long waitForText(int fd, const char *text, int timeoutMs);
+bool drain(int fd, int ms);
+void copyReport(int fd, FILE *out);
+void usage(const char *program);
+
+/* Main function - entry point of the program */
+int main(int argc, char *argv[]) {
+    const char *gamePath = "./snake";
+    int keys = 200;
+    int intervalMs = 250;
+    int timeoutMs = 1000;
+    static long long samples[MAX_KEYS];
+    int count = 0;
+    int missed = 0;
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--game") == 0 && i + 1 < argc) {
+            gamePath = argv[++i];
+        } else if (strcmp(argv[i], "--keys") == 0 && i + 1 < argc) {
+            keys = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--interval-ms") == 0 && i + 1 < argc) {
+            intervalMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--timeout-ms") == 0 && i + 1 < argc) {
+            timeoutMs = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (keys < 1 || keys > MAX_KEYS) {
+        keys = keys < 1 ? 1 : MAX_KEYS;
+    }
+
+    /* Start the game on a pseudo-terminal big enough for the board */
+    struct winsize size = { .ws_row = HEIGHT + 10, .ws_col = WIDTH + 60 };
+    int master;
+    pid_t child = forkpty(&master, NULL, NULL, &size);
+    if (child < 0) {
+        perror("forkpty");
+        return 1;
+    }
+    if (child == 0) {
+        setenv("TERM", "xterm", 1);
+        execl(gamePath, gamePath, "--latency", (char *)NULL);
+        fprintf(stderr, "Could not run %s: %s\n", gamePath, strerror(errno));
+        _exit(127);
+    }
+
+    /* The first frame shows the starting heading */
+    if (waitForText(master, "Heading: RIGHT", 5000) < 0) {
+        fprintf(stderr, "No frame from %s (is it built with --latency?)\n", gamePath);
+        kill(child, SIGTERM);
+        waitpid(child, NULL, 0);
+        return 1;
+    }
+
+    /* Type the turns, one per interval */
+    bool running = true;
+    for (int k = 0; k < keys && running; k++) {
+        int heading = turnPattern[k % 4];
+        char text[32];
+
+        running = drain(master, intervalMs);
+        if (!running) {
+            break;
+        }
+        snprintf(text, sizeof(text), "Heading: %s", headingNames[heading]);
+        long long start = nowNs();
+        if (write(master, &headingKeys[heading], 1) != 1) {
+            break;
+        }
+        long long seen = waitForText(master, text, timeoutMs);
+        if (seen < 0) {
+            missed++;
+            continue;
+        }
+        samples[count++] = seen - start;
+    }
+
+    /* Quit and collect the game's own report */
+    printf("Typed %d turns into %s (%d not seen within %d ms)%s\n",
+           count + missed, gamePath, missed, timeoutMs,
+           running ? "" : ", game ended early");
+    if (!running || write(master, "q", 1) == 1) {
+        copyReport(master, stdout);
+    }
+    waitpid(child, NULL, 0);
+    printLatency("Key written to frame read back", samples, count, stdout);
+    close(master);
+    return count > 0 ? 0 : 1;
+}
+
+/* Read the terminal until the text appears; returns the time it was seen,
+ * or -1 on timeout or when the game has gone */
+long long waitForText(int fd, const char *text, int timeoutMs) {
+    size_t length = strlen(text);
+    char window[4096 + 64];
+    size_t kept = 0;
+    long long deadline = nowNs() + (long long)timeoutMs * 1000000LL;
+
+    for (;;) {
+        long long left = deadline - nowNs();
+        if (left <= 0) {
+            return -1;
+        }
+        struct pollfd poller = { .fd = fd, .events = POLLIN };
+        if (poll(&poller, 1, (int)(left / 1000000LL) + 1) <= 0) {
+            continue;
+        }
+        ssize_t got = read(fd, window + kept, sizeof(window) - kept - 1);
+        if (got <= 0) {
+            return -1;
+        }
+        long long now = nowNs();
+        kept += got;
+        window[kept] = '\0';
+        if (memmem(window, kept, text, length) != NULL) {
+            return now;
+        }
+
+        /* Keep the tail, in case the text straddles two reads */
+        if (kept >= length) {
+            memmove(window, window + kept - (length - 1), length - 1);
+            kept = length - 1;
+        }
+    }
+}
+
+/* Throw away the terminal's output for a while; false once the game has gone */
+bool drain(int fd, int ms) {
+    char buffer[4096];
+    long long deadline = nowNs() + (long long)ms * 1000000LL;
+
+    for (;;) {
+        long long left = deadline - nowNs();
+        if (left <= 0) {
+            return true;
+        }
+        struct pollfd poller = { .fd = fd, .events = POLLIN };
+        if (poll(&poller, 1, (int)(left / 1000000LL) + 1) > 0 &&
+            read(fd, buffer, sizeof(buffer)) <= 0) {
+            return false;
+        }
+    }
+}
+
+/* Copy what the game prints after leaving the screen, from its report on */
+void copyReport(int fd, FILE *out) {
+    static char text[1 << 16];
+    size_t length = 0;
+
+    for (;;) {
+        struct pollfd poller = { .fd = fd, .events = POLLIN };
+        if (poll(&poller, 1, 2000) <= 0 || length + 1 >= sizeof(text)) {
+            break;
+        }
+        ssize_t got = read(fd, text + length, sizeof(text) - length - 1);
+        if (got <= 0) {
+            break;
+        }
+        length += got;
+    }
+    text[length] = '\0';
+
+    char *report = strstr(text, "Key to screen");
+    if (report != NULL) {
+        /* The terminal turned newlines into CR LF */
+        for (char *c = report; *c != '\0'; c++) {
+            if (*c != '\r') {
+                fputc(*c, out);
+            }
+        }
+    }
+}
+
+/* Print command line help */
+void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --game PATH       Game to run (default ./snake)\n");
+    fprintf(stderr, "  --keys N          Turns to type (default 200)\n");
+    fprintf(stderr, "  --interval-ms N   Time between turns (default 250)\n");
+    fprintf(stderr, "  --timeout-ms N    Give up on a turn after this long (default 1000)\n");
+}
@@ -0,0 +1,449 @@
+/**
+ * Snake Game - Server Load Generator (snake-load)
+ *
+ * Opens many connections to snake-server, starts many games on each and
+ * keeps them going for a while: every tick line is counted, now and then a
+ * game is sent a random turn, and a game that ends is replaced by a new
+ * one. At the end it prints how many tick lines arrived against how many
+ * the games' schedules promised, and how far apart consecutive ticks of the
+ * same game arrived compared with the tick length (the jitter).
+ *
+ * With --verify it also runs its own copy of every game from the seed the
+ * server sends, moves it the way the server's head moved, and checks the
+ * copy against every tick line and every state hash: a desync shows up on
+ * the tick it happens.
+ *
+ * Everything runs on one thread with one epoll loop, so the generator
+ * itself needs very little CPU.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include "game.h"
+#include "snake_net.h"
+#include "clock.h"
+
+#define LOAD_MAX_CONNECTIONS 4096
+#define LOAD_IN_BYTES        65536
+#define JITTER_BUCKETS       1000    // 0.1 ms each, so up to 100 ms
+#define TURN_ONE_IN          8       // A game is turned on one tick in this many
+
+/* A local copy of one of the server's games (--verify) */
+typedef struct {
+    Arena arena;
+    Game game;
+    bool live;                   // Started, and not yet over or out of step
+} GameMirror;
+
+/* One connection and its games */
+typedef struct {
+    int fd;
+    int inLength;
+    char in[LOAD_IN_BYTES];
+    long long *lastTick;         // Arrival time of each game's last tick, by ID
+    GameMirror **mirrors;        // Copies of the games, by ID (--verify)
+    int gameSlots;
+} LoadConnection;
+
+/* Totals over all connections */
+typedef struct {
+    long long ticks;
+    long long games;             // Games started
+    long long overs;             // Games that ended
+    long long errors;            // error lines
+    long long overlong;          // Connections dropped for a line that did not fit
+    long long jitter[JITTER_BUCKETS + 1];
+    long long jitterSamples;
+    uint64_t rng;
+    int tickMs;
+    bool verify;                 // Keep a copy of every game and compare
+    long long verified;          // Hashes that matched the copy
+    long long desyncs;           // Games whose copy went out of step
+} Load;
+
+/* Function prototypes */
+int connectTo(const char *host, int port);
+void sendText(LoadConnection *connection, const char *text);
+void handleData(Load *load, LoadConnection *connection, long long now);
+void handleLoadLine(Load *load, LoadConnection *connection, char *line, long long now);
+bool growGames(LoadConnection *connection, unsigned id);
+void noteTick(Load *load, LoadConnection *connection, unsigned id, long long now);
+void startMirror(LoadConnection *connection, unsigned id, uint64_t seed);
+void checkMirror(Load *load, LoadConnection *connection, unsigned id, const char *line);
+double jitterPercentile(const Load *load, double fraction);
+void usage(const char *program);
+
+/* Main function - entry point of the program */
+int main(int argc, char *argv[]) {
+    static LoadConnection connections[LOAD_MAX_CONNECTIONS];
+    static Load load;
+    const char *host = "127.0.0.1";
+    int port = SNAKE_NET_DEFAULT_PORT;
+    int connectionCount = 10;
+    int gamesPerConnection = 100;
+    double seconds = 10;
+
+    load.tickMs = SNAKE_NET_DEFAULT_TICK;
+    load.rng = (uint64_t)time(NULL) | 1;
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+            host = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--connections") == 0 && i + 1 < argc) {
+            connectionCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            gamesPerConnection = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tick-ms") == 0 && i + 1 < argc) {
+            load.tickMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            load.verify = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (connectionCount < 1 || connectionCount > LOAD_MAX_CONNECTIONS ||
+        gamesPerConnection < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    struct rlimit files;
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0) {
+        files.rlim_cur = files.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &files);
+    }
+
+    /* Connect and start the games */
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    for (int c = 0; c < connectionCount; c++) {
+        LoadConnection *connection = &connections[c];
+        connection->fd = connectTo(host, port);
+        if (connection->fd < 0) {
+            fprintf(stderr, "Could not connect to %s:%d: %s\n", host, port, strerror(errno));
+            return 1;
+        }
+        char text[SNAKE_NET_MAX_LINE];
+        snprintf(text, sizeof(text), "new %d\n", load.tickMs);
+        for (int g = 0; g < gamesPerConnection; g++) {
+            sendText(connection, text);
+        }
+        load.games += gamesPerConnection;
+        struct epoll_event event = { .events = EPOLLIN, .data.ptr = connection };
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, connection->fd, &event);
+    }
+    printf("Running %d games on %d connections to %s:%d, %d ms ticks, for %.0f s\n",
+           connectionCount * gamesPerConnection, connectionCount, host, port,
+           load.tickMs, seconds);
+    fflush(stdout);
+
+    /* Play */
+    long long start = nowNs();
+    long long end = start + (long long)(seconds * 1e9);
+    int open = connectionCount;
+    while (open > 0 && nowNs() < end) {
+        struct epoll_event events[256];
+        int count = epoll_wait(epollFd, events, 256, 100);
+        long long now = nowNs();
+        for (int e = 0; e < count; e++) {
+            LoadConnection *connection = events[e].data.ptr;
+            handleData(&load, connection, now);
+            if (connection->fd < 0) {
+                open--;
+            }
+        }
+    }
+    double elapsed = (nowNs() - start) / 1e9;
+
+    /* Report */
+    double expected = (double)connectionCount * gamesPerConnection *
+                      elapsed * 1000.0 / load.tickMs;
+    printf("%lld tick lines in %.1f s (%.0f/s, %.1f%% of the schedule), "
+           "%lld games ended, %lld errors\n",
+           load.ticks, elapsed, load.ticks / elapsed, 100.0 * load.ticks / expected,
+           load.overs, load.errors);
+    if (load.jitterSamples > 0) {
+        printf("Tick spacing off by: p50 %.1f ms, p99 %.1f ms, p99.9 %.1f ms%s\n",
+               jitterPercentile(&load, 0.5), jitterPercentile(&load, 0.99),
+               jitterPercentile(&load, 0.999),
+               load.jitter[JITTER_BUCKETS] > 0 ? " (some over 100 ms)" : "");
+    }
+    if (load.verify) {
+        printf("Verified %lld state hashes against local copies of the games: "
+               "%lld desyncs\n", load.verified, load.desyncs);
+    }
+    if (load.overlong > 0) {
+        printf("%lld connections were dropped for sending a line over %d bytes\n",
+               load.overlong, LOAD_IN_BYTES);
+    }
+    if (open + load.overlong < connectionCount) {
+        printf("%lld connections were closed by the server\n",
+               connectionCount - open - load.overlong);
+    }
+    return 0;
+}
+
+/* Open a TCP connection with Nagle's algorithm off. The socket stays
+ * blocking: it is only read after epoll reports data, so reads never wait. */
+int connectTo(const char *host, int port) {
+    struct sockaddr_in address;
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int one = 1;
+
+    if (fd < 0) {
+        return -1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host, &address.sin_addr) != 1 ||
+        connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+/* Send a command; the commands are tiny, so a blocking write is fine */
+void sendText(LoadConnection *connection, const char *text) {
+    size_t length = strlen(text);
+    if (connection->fd >= 0 && write(connection->fd, text, length) != (ssize_t)length) {
+        close(connection->fd);
+        connection->fd = -1;
+    }
+}
+
+/* Read what the server sent and handle every complete line. A full buffer
+ * with no newline in it is a line far past SNAKE_NET_MAX_LINE, so the
+ * connection is dropped rather than read with no room left. */
+void handleData(Load *load, LoadConnection *connection, long long now) {
+    ssize_t got = read(connection->fd, connection->in + connection->inLength,
+                       LOAD_IN_BYTES - connection->inLength);
+    if (got <= 0) {
+        if (got == 0 || (errno != EAGAIN && errno != EINTR)) {
+            close(connection->fd);
+            connection->fd = -1;
+        }
+        return;
+    }
+    connection->inLength += (int)got;
+
+    int start = 0;
+    for (int i = 0; i < connection->inLength; i++) {
+        if (connection->in[i] == '\n') {
+            connection->in[i] = '\0';
+            handleLoadLine(load, connection, connection->in + start, now);
+            start = i + 1;
+        }
+    }
+    memmove(connection->in, connection->in + start, connection->inLength - start);
+    connection->inLength -= start;
+
+    if (connection->inLength == LOAD_IN_BYTES) {
+        load->overlong++;
+        close(connection->fd);
+        connection->fd = -1;
+    }
+}
+
+/* Count one line from the server and answer it if needed */
+void handleLoadLine(Load *load, LoadConnection *connection, char *line, long long now) {
+    unsigned id;
+    char text[SNAKE_NET_MAX_LINE];
+
+    if (sscanf(line, "tick %u", &id) == 1) {
+        load->ticks++;
+        noteTick(load, connection, id, now);
+        if (load->verify) {
+            checkMirror(load, connection, id, line);
+        }
+        if (gameRandomBelow(&load->rng, TURN_ONE_IN) == 0) {
+            snprintf(text, sizeof(text), "turn %u %c\n", id,
+                     "urdl"[gameRandomBelow(&load->rng, 4)]);
+            sendText(connection, text);
+        }
+    } else if (sscanf(line, "game %u", &id) == 1) {
+        unsigned long long seed;
+        noteTick(load, connection, id, 0);
+        if (load->verify && sscanf(line, "game %*u %llu", &seed) == 1) {
+            startMirror(connection, id, seed);
+        }
+    } else if (sscanf(line, "over %u", &id) == 1) {
+        if (load->verify && (int)id < connection->gameSlots && connection->mirrors[id] != NULL) {
+            connection->mirrors[id]->live = false;
+        }
+        load->overs++;
+        load->games++;
+        snprintf(text, sizeof(text), "new %d\n", load->tickMs);
+        sendText(connection, text);
+    } else if (strncmp(line, "error", 5) == 0) {
+        load->errors++;
+    }
+}
+
+/* Make room for the per-game records of game ID */
+bool growGames(LoadConnection *connection, unsigned id) {
+    if ((int)id < connection->gameSlots) {
+        return true;
+    }
+    int size = connection->gameSlots ? connection->gameSlots : 256;
+    while (size <= (int)id) {
+        size *= 2;
+    }
+    long long *ticks = realloc(connection->lastTick, size * sizeof(long long));
+    if (ticks != NULL) {
+        connection->lastTick = ticks;
+    }
+    GameMirror **mirrors = realloc(connection->mirrors, size * sizeof(GameMirror *));
+    if (mirrors != NULL) {
+        connection->mirrors = mirrors;
+    }
+    if (ticks == NULL || mirrors == NULL) {
+        return false;
+    }
+    memset(ticks + connection->gameSlots, 0,
+           (size - connection->gameSlots) * sizeof(long long));
+    memset(mirrors + connection->gameSlots, 0,
+           (size - connection->gameSlots) * sizeof(GameMirror *));
+    connection->gameSlots = size;
+    return true;
+}
+
+/* Record a game's tick time, and how far it was from one tick after the last */
+void noteTick(Load *load, LoadConnection *connection, unsigned id, long long now) {
+    if (!growGames(connection, id)) {
+        return;
+    }
+
+    long long last = connection->lastTick[id];
+    connection->lastTick[id] = now;
+    if (last == 0 || now == 0) {
+        return;  // The game has just started
+    }
+    long long off = now - last - (long long)load->tickMs * 1000000LL;
+    if (off < 0) {
+        off = -off;
+    }
+    long long bucket = off / 100000;  // 0.1 ms
+    load->jitter[bucket < JITTER_BUCKETS ? bucket : JITTER_BUCKETS]++;
+    load->jitterSamples++;
+}
+
+/* Start the local copy of a game; IDs are reused, and so are copies */
+void startMirror(LoadConnection *connection, unsigned id, uint64_t seed) {
+    if (!growGames(connection, id)) {
+        return;
+    }
+    GameMirror *mirror = connection->mirrors[id];
+    if (mirror == NULL) {
+        mirror = calloc(1, sizeof(GameMirror));
+        if (mirror == NULL || !arenaInit(&mirror->arena, GAME_ARENA_BYTES)) {
+            free(mirror);
+            return;
+        }
+        connection->mirrors[id] = mirror;
+    }
+    arenaReset(&mirror->arena);
+    mirror->live = initializeGame(&mirror->game, &mirror->arena, seed);
+}
+
+/* Move the copy of a game the way the server's head moved, and compare it
+ * with the tick line. The first mismatch is printed; the game is then left
+ * alone, since every later tick would differ too. */
+void checkMirror(Load *load, LoadConnection *connection, unsigned id, const char *line) {
+    unsigned ticks, score;
+    Point head, food;
+    unsigned long long hash = 0;
+
+    if ((int)id >= connection->gameSlots || connection->mirrors[id] == NULL ||
+        !connection->mirrors[id]->live) {
+        return;
+    }
+    GameMirror *mirror = connection->mirrors[id];
+    int fields = sscanf(line, "tick %*u %u %u %d %d %d %d %llx", &ticks, &score,
+                        &head.x, &head.y, &food.x, &food.y, &hash);
+    if (fields < 6) {
+        return;
+    }
+
+    /* The server turned the snake, if at all, just before this move */
+    Game *game = &mirror->game;
+    int direction = -1;
+    for (int dir = 0; dir < 4 && direction < 0; dir++) {
+        Point next = nextHead(&game->snake, dir);
+        if (next.x == head.x && next.y == head.y) {
+            direction = dir;
+        }
+    }
+    const char *problem = NULL;
+    if (direction < 0) {
+        problem = "head is not next to the copy's head";
+    } else {
+        turnSnake(&game->snake, direction);
+        stepGame(game);
+        if ((unsigned)game->stats.ticks != ticks ||
+            (unsigned)(game->snake.size - INITIAL_SIZE) != score) {
+            problem = "tick count or score differs";
+        } else if (game->food.x != food.x || game->food.y != food.y) {
+            problem = "food differs";
+        } else if (fields == 7 && gameHash(game) != hash) {
+            problem = "state hash differs";
+        } else if (fields == 7) {
+            load->verified++;
+        }
+    }
+    if (problem != NULL) {
+        if (load->desyncs == 0) {
+            fprintf(stderr, "Desync in game %u at \"%s\": %s (copy at tick %d, hash %016llx)\n",
+                    id, line, problem, game->stats.ticks,
+                    (unsigned long long)gameHash(game));
+        }
+        load->desyncs++;
+        mirror->live = false;
+    }
+}
+
+/* Jitter in milliseconds below which the given share of samples fall */
+double jitterPercentile(const Load *load, double fraction) {
+    long long wanted = (long long)(fraction * load->jitterSamples);
+    long long seen = 0;
+    for (int b = 0; b <= JITTER_BUCKETS; b++) {
+        seen += load->jitter[b];
+        if (seen > wanted) {
+            return (b + 1) * 0.1;
+        }
+    }
+    return JITTER_BUCKETS * 0.1;
+}
+
+/* Print command line help */
+void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --host ADDRESS     Server address (default 127.0.0.1)\n");
+    fprintf(stderr, "  --port N           Server port (default %d)\n", SNAKE_NET_DEFAULT_PORT);
+    fprintf(stderr, "  --connections N    Connections to open (default 10)\n");
+    fprintf(stderr, "  --games N          Games per connection (default 100)\n");
+    fprintf(stderr, "  --tick-ms N        Tick length of the games (default %d)\n",
+            SNAKE_NET_DEFAULT_TICK);
+    fprintf(stderr, "  --seconds N        How long to run (default 10)\n");
+    fprintf(stderr, "  --verify           Keep a copy of every game and check it against\n"
+                    "                     the server's ticks and state hashes\n");
+}
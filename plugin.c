@@ -0,0 +1,136 @@
+/**
+ * Snake Game - Bot Plugin Loader
+ *
+ * See plugin.h. Filling in the view costs a handful of stores per move: the
+ * body ring and the occupancy grid are handed over by pointer, because
+ * SnakeBotPoint has exactly the same layout as Point.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "plugin.h"
+#include "clock.h"
+
+/* Compile-time check that the game's Point can be passed as SnakeBotPoint */
+typedef char pointLayoutMatches[(sizeof(Point) == sizeof(SnakeBotPoint) &&
+                                 offsetof(Point, y) == offsetof(SnakeBotPoint, y))
+                                ? 1 : -1];
+
+/* Open a plugin, check its ABI version and create its state */
+bool loadPluginBot(PluginBot *bot, const char *path, const char *args,
+                   long budgetNs, char *error, size_t errorSize) {
+    const SnakeBotPlugin *(*entry)(void);
+
+    memset(bot, 0, sizeof(PluginBot));
+    bot->budgetNs = budgetNs;
+
+    bot->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (bot->handle == NULL) {
+        snprintf(error, errorSize, "%s", dlerror());
+        return false;
+    }
+
+    /* POSIX guarantees a data pointer from dlsym() converts to a function */
+    *(void **)&entry = dlsym(bot->handle, SNAKE_BOT_ENTRY);
+    if (entry == NULL) {
+        snprintf(error, errorSize, "%s does not export %s", path, SNAKE_BOT_ENTRY);
+        unloadPluginBot(bot);
+        return false;
+    }
+
+    bot->api = entry();
+    if (bot->api == NULL || bot->api->move == NULL) {
+        snprintf(error, errorSize, "%s has no move function", path);
+        unloadPluginBot(bot);
+        return false;
+    }
+    if (bot->api->abiVersion == 0 || bot->api->abiVersion > SNAKE_BOT_ABI_VERSION) {
+        snprintf(error, errorSize, "%s needs bot ABI version %u (this game has %d)",
+                 path, bot->api->abiVersion, SNAKE_BOT_ABI_VERSION);
+        unloadPluginBot(bot);
+        return false;
+    }
+
+    if (bot->api->create != NULL) {
+        bot->state = bot->api->create(args != NULL ? args : "");
+    }
+
+    /* The parts of the view that never change */
+    bot->view.abiVersion = SNAKE_BOT_ABI_VERSION;
+    bot->view.width = WIDTH;
+    bot->view.height = HEIGHT;
+    bot->view.budgetNs = budgetNs;
+    return true;
+}
+
+/* Ask the plugin for a move, timing the call */
+int pluginChooseMove(PluginBot *bot, const Game *game, uint64_t tick) {
+    const Snake *snake = &game->snake;
+    SnakeBotView *view = &bot->view;
+
+    if (bot->disqualified) {
+        return snake->direction;
+    }
+
+    /* Point the view at the live game; nothing is copied */
+    view->size = snake->size;
+    view->direction = snake->direction;
+    view->ringHead = snake->head;
+    view->ringMask = snake->capacity - 1;
+    view->ring = (const SnakeBotPoint *)snake->body;
+    view->occupied = snake->occupied;
+    view->food.x = game->food.x;
+    view->food.y = game->food.y;
+    view->tick = tick;
+
+    long long start = nowNs();
+    int direction = bot->api->move(bot->state, view);
+    long long elapsed = nowNs() - start;
+
+    bot->calls++;
+    bot->totalSeconds += elapsed / 1e9;
+    if (elapsed / 1e9 > bot->worstSeconds) {
+        bot->worstSeconds = elapsed / 1e9;
+    }
+
+    /* A late or invalid answer is ignored: the snake keeps going */
+    if (bot->budgetNs > 0 && elapsed > bot->budgetNs) {
+        bot->lateCalls++;
+        if (bot->lateCalls >= PLUGIN_MAX_STRIKES) {
+            bot->disqualified = true;
+        }
+        return snake->direction;
+    }
+    if (direction < UP || direction > LEFT) {
+        return snake->direction;
+    }
+    return direction;
+}
+
+/* Describe how long the plugin took, in one line */
+void formatPluginStats(const PluginBot *bot, char *text, size_t size) {
+    if (bot->api == NULL) {
+        snprintf(text, size, "Bot not loaded");
+        return;
+    }
+    snprintf(text, size, "Bot %s: %ld moves, %.2f us average, %.2f us worst, %ld late%s",
+             bot->api->name != NULL ? bot->api->name : "?", bot->calls,
+             bot->calls ? bot->totalSeconds * 1e6 / bot->calls : 0.0,
+             bot->worstSeconds * 1e6, bot->lateCalls,
+             bot->disqualified ? " (disqualified)" : "");
+}
+
+/* Destroy the plugin's state and close the library */
+void unloadPluginBot(PluginBot *bot) {
+    if (bot->api != NULL && bot->api->destroy != NULL) {
+        bot->api->destroy(bot->state);
+    }
+    if (bot->handle != NULL) {
+        dlclose(bot->handle);
+    }
+    memset(bot, 0, sizeof(PluginBot));
+}
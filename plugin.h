@@ -0,0 +1,40 @@
+/**
+ * Snake Game - Bot Plugin Loader
+ *
+ * Loads bot plugins (see snake_bot.h) with dlopen() and runs them with a time
+ * budget. A plugin runs inside the game process, so a slow move cannot be cut
+ * short; instead, a move that comes back after the budget is thrown away (the
+ * snake keeps its heading), and a plugin that is late too often is
+ * disqualified and never called again.
+ */
+
+#ifndef PLUGIN_H
+#define PLUGIN_H
+
+#include "game.h"
+#include "snake_bot.h"
+
+#define PLUGIN_MAX_STRIKES 10  // Late moves before a plugin is disqualified
+
+/* A loaded plugin and its timing record */
+typedef struct {
+    void *handle;                  // From dlopen()
+    const SnakeBotPlugin *api;
+    void *state;                   // From the plugin's create()
+    SnakeBotView view;             // Reused every call; only pointers change
+    long budgetNs;                 // Time allowed per move
+    long calls;
+    long lateCalls;
+    double totalSeconds;
+    double worstSeconds;
+    bool disqualified;
+} PluginBot;
+
+/* Function prototypes */
+bool loadPluginBot(PluginBot *bot, const char *path, const char *args,
+                   long budgetNs, char *error, size_t errorSize);
+int pluginChooseMove(PluginBot *bot, const Game *game, uint64_t tick);
+void formatPluginStats(const PluginBot *bot, char *text, size_t size);
+void unloadPluginBot(PluginBot *bot);
+
+#endif /* PLUGIN_H */
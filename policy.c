@@ -0,0 +1,372 @@
+/**
+ * Snake Game - Neural Network Policy
+ *
+ * See policy.h. The weight file is plain text:
+ *   snake-policy <inputs> <hidden>
+ * followed by the hidden weights (row by row), hidden biases, output weights
+ * and output biases, all as whitespace-separated numbers.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__AVX__) || defined(__SSE__)
+#include <immintrin.h>
+#endif
+#include "policy.h"
+
+/* Forward and right vectors for each heading, used to rotate the window */
+static const Point FORWARD[4] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+static const Point RIGHTWARD[4] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+
+/* Allocate a zeroed, 32-byte aligned float array */
+static float *allocFloats(int count) {
+    void *memory = NULL;
+    if (posix_memalign(&memory, 32, count * sizeof(float)) != 0) {
+        return NULL;
+    }
+    memset(memory, 0, count * sizeof(float));
+    return memory;
+}
+
+/* Allocate the weight arrays */
+static bool allocPolicy(Policy *policy) {
+    policy->hiddenWeights = allocFloats(POLICY_HIDDEN * POLICY_INPUTS);
+    policy->hiddenBias = allocFloats(POLICY_HIDDEN);
+    policy->outputWeights = allocFloats(POLICY_OUTPUTS * POLICY_HIDDEN);
+    policy->outputBias = allocFloats(POLICY_OUTPUTS);
+    if (policy->hiddenWeights == NULL || policy->hiddenBias == NULL ||
+        policy->outputWeights == NULL || policy->outputBias == NULL) {
+        freePolicy(policy);
+        return false;
+    }
+    return true;
+}
+
+/* Release the weight arrays */
+void freePolicy(Policy *policy) {
+    free(policy->hiddenWeights);
+    free(policy->hiddenBias);
+    free(policy->outputWeights);
+    free(policy->outputBias);
+    memset(policy, 0, sizeof(Policy));
+}
+
+/* Read 'count' numbers into 'values' */
+static bool readFloats(FILE *file, float *values, int count) {
+    for (int i = 0; i < count; i++) {
+        if (fscanf(file, "%f", &values[i]) != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Load weights from a file; the network shape has to match this build */
+bool loadPolicy(Policy *policy, const char *path) {
+    int inputs = 0;
+    int hidden = 0;
+    bool ok;
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        return false;
+    }
+    if (fscanf(file, "snake-policy %d %d", &inputs, &hidden) != 2 ||
+        inputs != POLICY_FEATURES || hidden != POLICY_HIDDEN ||
+        !allocPolicy(policy)) {
+        fclose(file);
+        return false;
+    }
+
+    /* Rows are stored unpadded in the file */
+    ok = true;
+    for (int row = 0; ok && row < POLICY_HIDDEN; row++) {
+        ok = readFloats(file, &policy->hiddenWeights[row * POLICY_INPUTS],
+                        POLICY_FEATURES);
+    }
+    ok = ok && readFloats(file, policy->hiddenBias, POLICY_HIDDEN) &&
+         readFloats(file, policy->outputWeights, POLICY_OUTPUTS * POLICY_HIDDEN) &&
+         readFloats(file, policy->outputBias, POLICY_OUTPUTS);
+
+    fclose(file);
+    if (!ok) {
+        freePolicy(policy);
+    }
+    return ok;
+}
+
+/* Write one array of numbers, eight per line */
+static void writeFloats(FILE *file, const float *values, int count) {
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "%.7g%c", values[i], (i % 8 == 7 || i == count - 1) ? '\n' : ' ');
+    }
+}
+
+/* Save weights in the format loadPolicy() reads */
+bool savePolicy(const Policy *policy, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, "snake-policy %d %d\n", POLICY_FEATURES, POLICY_HIDDEN);
+    for (int row = 0; row < POLICY_HIDDEN; row++) {
+        writeFloats(file, &policy->hiddenWeights[row * POLICY_INPUTS], POLICY_FEATURES);
+    }
+    writeFloats(file, policy->hiddenBias, POLICY_HIDDEN);
+    writeFloats(file, policy->outputWeights, POLICY_OUTPUTS * POLICY_HIDDEN);
+    writeFloats(file, policy->outputBias, POLICY_OUTPUTS);
+
+    return fclose(file) == 0;
+}
+
+/* Fill a new policy with small random weights (a starting point for training) */
+bool randomPolicy(Policy *policy, uint64_t seed) {
+    uint64_t rng = seed ? seed : 1;
+
+    if (!allocPolicy(policy)) {
+        return false;
+    }
+
+    /* Uniform in +-1/sqrt(fan-in), the usual scale for ReLU layers */
+    float hiddenScale = 1.0f / sqrtf((float)POLICY_FEATURES);
+    float outputScale = 1.0f / sqrtf((float)POLICY_HIDDEN);
+    for (int row = 0; row < POLICY_HIDDEN; row++) {
+        for (int i = 0; i < POLICY_FEATURES; i++) {
+            float u = gameRandom(&rng) / 4294967296.0f * 2.0f - 1.0f;
+            policy->hiddenWeights[row * POLICY_INPUTS + i] = u * hiddenScale;
+        }
+    }
+    for (int i = 0; i < POLICY_OUTPUTS * POLICY_HIDDEN; i++) {
+        float u = gameRandom(&rng) / 4294967296.0f * 2.0f - 1.0f;
+        policy->outputWeights[i] = u * outputScale;
+    }
+    return true;
+}
+
+/* Wrap a coordinate into the playing area 1 .. size - 2 */
+static int wrapInside(int value, int size) {
+    int inner = size - 2;
+    int offset = (value - 1) % inner;
+    return 1 + (offset < 0 ? offset + inner : offset);
+}
+
+/* Shortest signed distance from a to b along an axis that wraps */
+static int wrapDelta(int a, int b, int size) {
+    int inner = size - 2;
+    int delta = b - a;
+    if (delta > inner / 2) delta -= inner;
+    if (delta < -inner / 2) delta += inner;
+    return delta;
+}
+
+/* Build the network input for a game, rotated so forward is the heading */
+void encodePolicyInput(const Game *game, float *input) {
+    const Snake *snake = &game->snake;
+    Point head = snakeSegment(snake, 0);
+    Point forward = FORWARD[snake->direction];
+    Point right = RIGHTWARD[snake->direction];
+    int index = 0;
+
+    memset(input, 0, POLICY_INPUTS * sizeof(float));
+
+    /* Row 0 of the window is furthest ahead, column 0 furthest to the left */
+    for (int ahead = POLICY_RADIUS; ahead >= -POLICY_RADIUS; ahead--) {
+        for (int side = -POLICY_RADIUS; side <= POLICY_RADIUS; side++) {
+            Point p;
+            p.x = wrapInside(head.x + ahead * forward.x + side * right.x, WIDTH);
+            p.y = wrapInside(head.y + ahead * forward.y + side * right.y, HEIGHT);
+
+            input[index] = isOccupied(snake, p) ? 1.0f : 0.0f;
+            input[POLICY_CELLS + index] =
+                (p.x == game->food.x && p.y == game->food.y) ? 1.0f : 0.0f;
+            index++;
+        }
+    }
+
+    /* Direction to the food, even when it is outside the window */
+    int dx = wrapDelta(head.x, game->food.x, WIDTH);
+    int dy = wrapDelta(head.y, game->food.y, HEIGHT);
+    float span = (float)(WIDTH + HEIGHT) / 2.0f;
+    input[2 * POLICY_CELLS] = (dx * forward.x + dy * forward.y) / span;
+    input[2 * POLICY_CELLS + 1] = (dx * right.x + dy * right.y) / span;
+}
+
+/* Dot products of one weight row with four input vectors at once, so every
+ * weight loaded from memory is used four times. 'n' is a multiple of 8. */
+static void dot4(const float *w, const float *x0, const float *x1,
+                 const float *x2, const float *x3, int n, float *out) {
+#if defined(__AVX__)
+    __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+    __m256 s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+    for (int i = 0; i < n; i += 8) {
+        __m256 wv = _mm256_load_ps(w + i);
+#if defined(__FMA__)
+        s0 = _mm256_fmadd_ps(wv, _mm256_load_ps(x0 + i), s0);
+        s1 = _mm256_fmadd_ps(wv, _mm256_load_ps(x1 + i), s1);
+        s2 = _mm256_fmadd_ps(wv, _mm256_load_ps(x2 + i), s2);
+        s3 = _mm256_fmadd_ps(wv, _mm256_load_ps(x3 + i), s3);
+#else
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(wv, _mm256_load_ps(x0 + i)));
+        s1 = _mm256_add_ps(s1, _mm256_mul_ps(wv, _mm256_load_ps(x1 + i)));
+        s2 = _mm256_add_ps(s2, _mm256_mul_ps(wv, _mm256_load_ps(x2 + i)));
+        s3 = _mm256_add_ps(s3, _mm256_mul_ps(wv, _mm256_load_ps(x3 + i)));
+#endif
+    }
+    /* Horizontal sums: fold 4 x 8 lanes into the four results */
+    __m256 a = _mm256_hadd_ps(s0, s1);
+    __m256 b = _mm256_hadd_ps(s2, s3);
+    __m256 c = _mm256_hadd_ps(a, b);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(c), _mm256_extractf128_ps(c, 1));
+    _mm_storeu_ps(out, sum);
+#elif defined(__SSE__)
+    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+    __m128 s2 = _mm_setzero_ps(), s3 = _mm_setzero_ps();
+    for (int i = 0; i < n; i += 4) {
+        __m128 wv = _mm_load_ps(w + i);
+        s0 = _mm_add_ps(s0, _mm_mul_ps(wv, _mm_load_ps(x0 + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(wv, _mm_load_ps(x1 + i)));
+        s2 = _mm_add_ps(s2, _mm_mul_ps(wv, _mm_load_ps(x2 + i)));
+        s3 = _mm_add_ps(s3, _mm_mul_ps(wv, _mm_load_ps(x3 + i)));
+    }
+    /* Transpose so each lane of the sum holds one result */
+    _MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+    _mm_storeu_ps(out, _mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3)));
+#else
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    for (int i = 0; i < n; i++) {
+        s0 += w[i] * x0[i];
+        s1 += w[i] * x1[i];
+        s2 += w[i] * x2[i];
+        s3 += w[i] * x3[i];
+    }
+    out[0] = s0;
+    out[1] = s1;
+    out[2] = s2;
+    out[3] = s3;
+#endif
+}
+
+/* Name of the kernel compiled in, for benchmark reports */
+const char *policyKernelName(void) {
+#if defined(__AVX__) && defined(__FMA__)
+    return "avx+fma";
+#elif defined(__AVX__)
+    return "avx";
+#elif defined(__SSE__)
+    return "sse";
+#else
+    return "scalar";
+#endif
+}
+
+/* One dense layer for a whole batch: out[g][row] = act(W[row] . in[g] + b[row]).
+ * Games are processed four at a time; a short last group reuses the final
+ * game's input and throws the extra results away. */
+static void denseLayer(const float *weights, const float *bias, int rows,
+                       int columns, const float *inputs, int count,
+                       bool relu, float *outputs) {
+    for (int g = 0; g < count; g += 4) {
+        const float *x[4];
+        for (int k = 0; k < 4; k++) {
+            int game = g + k < count ? g + k : count - 1;
+            x[k] = inputs + (size_t)game * columns;
+        }
+
+        for (int row = 0; row < rows; row++) {
+            float sums[4];
+            dot4(weights + (size_t)row * columns, x[0], x[1], x[2], x[3],
+                 columns, sums);
+            for (int k = 0; k < 4 && g + k < count; k++) {
+                float value = sums[k] + bias[row];
+                if (relu && value < 0.0f) {
+                    value = 0.0f;
+                }
+                outputs[(size_t)(g + k) * rows + row] = value;
+            }
+        }
+    }
+}
+
+/* Run the network on 'count' encoded inputs (POLICY_INPUTS floats each,
+ * 32-byte aligned) and write POLICY_OUTPUTS scores per game */
+void policyForwardBatch(const Policy *policy, const float *inputs, int count,
+                        float *outputs) {
+    static __thread float hidden[POLICY_MAX_BATCH * POLICY_HIDDEN]
+        __attribute__((aligned(32)));
+
+    for (int start = 0; start < count; start += POLICY_MAX_BATCH) {
+        int batch = count - start < POLICY_MAX_BATCH ? count - start : POLICY_MAX_BATCH;
+
+        denseLayer(policy->hiddenWeights, policy->hiddenBias, POLICY_HIDDEN,
+                   POLICY_INPUTS, inputs + (size_t)start * POLICY_INPUTS, batch,
+                   true, hidden);
+
+        /* The output layer is tiny (3 rows), so plain C is fast enough */
+        for (int g = 0; g < batch; g++) {
+            for (int out = 0; out < POLICY_OUTPUTS; out++) {
+                float sum = policy->outputBias[out];
+                for (int i = 0; i < POLICY_HIDDEN; i++) {
+                    sum += policy->outputWeights[out * POLICY_HIDDEN + i] *
+                           hidden[g * POLICY_HIDDEN + i];
+                }
+                outputs[(size_t)(start + g) * POLICY_OUTPUTS + out] = sum;
+            }
+        }
+    }
+}
+
+/* Pick the best-scoring move, skipping moves straight into the body */
+static int bestMove(const Game *game, const float *scores) {
+    const Snake *snake = &game->snake;
+    int best = -1;
+
+    for (int move = 0; move < POLICY_OUTPUTS; move++) {
+        int dir = (snake->direction + 3 + move) % 4;
+        Point next = nextHead(snake, dir);
+        if (!cellSafeAt(snake, next, 1)) {
+            continue;
+        }
+        if (best < 0 || scores[move] > scores[best]) {
+            best = move;
+        }
+    }
+
+    /* Every move is fatal: just keep going */
+    if (best < 0) {
+        return snake->direction;
+    }
+    return (snake->direction + 3 + best) % 4;
+}
+
+/* Decide the next direction for a batch of games with one forward pass */
+void policyChooseMoves(const Policy *policy, const Game *const *games,
+                       int count, int *directions) {
+    static __thread float inputs[POLICY_MAX_BATCH * POLICY_INPUTS]
+        __attribute__((aligned(32)));
+    static __thread float scores[POLICY_MAX_BATCH * POLICY_OUTPUTS];
+
+    for (int start = 0; start < count; start += POLICY_MAX_BATCH) {
+        int batch = count - start < POLICY_MAX_BATCH ? count - start : POLICY_MAX_BATCH;
+
+        for (int g = 0; g < batch; g++) {
+            encodePolicyInput(games[start + g], &inputs[g * POLICY_INPUTS]);
+        }
+        policyForwardBatch(policy, inputs, batch, scores);
+        for (int g = 0; g < batch; g++) {
+            directions[start + g] = bestMove(games[start + g],
+                                             &scores[g * POLICY_OUTPUTS]);
+        }
+    }
+}
+
+/* Decide the next direction for a single game */
+int policyChooseMove(const Policy *policy, const Game *game) {
+    int direction;
+    policyChooseMoves(policy, &game, 1, &direction);
+    return direction;
+}
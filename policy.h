@@ -0,0 +1,50 @@
+/**
+ * Snake Game - Neural Network Policy
+ *
+ * A tiny two-layer network (MLP) that looks at the cells around the snake's
+ * head and scores the three possible moves. The input is always rotated so
+ * that "forward" is the snake's heading, which lets the network learn one
+ * rule for all four directions.
+ *
+ * Inference is done in batches, so one call can decide the moves of many
+ * games at once. The inner loops use AVX or SSE when the compiler enables
+ * them (for example make SIMD=-mavx2) and plain C otherwise.
+ */
+
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "game.h"
+
+/* Network Shape */
+#define POLICY_RADIUS  4    // The window reaches this many cells from the head
+#define POLICY_WINDOW  (2 * POLICY_RADIUS + 1)
+#define POLICY_CELLS   (POLICY_WINDOW * POLICY_WINDOW)
+#define POLICY_FEATURES (2 * POLICY_CELLS + 2)  // Body plane, food plane, food vector
+#define POLICY_INPUTS  ((POLICY_FEATURES + 7) & ~7)  // Padded to 8 floats
+#define POLICY_HIDDEN  32   // Hidden units (a multiple of 8)
+#define POLICY_OUTPUTS 3    // Turn left, go straight, turn right
+#define POLICY_MAX_BATCH 64   // Games encoded per internal batch
+
+/* Network weights (row-major, 32-byte aligned, rows padded with zeros) */
+typedef struct {
+    float *hiddenWeights;   // POLICY_HIDDEN x POLICY_INPUTS
+    float *hiddenBias;      // POLICY_HIDDEN
+    float *outputWeights;   // POLICY_OUTPUTS x POLICY_HIDDEN
+    float *outputBias;      // POLICY_OUTPUTS
+} Policy;
+
+/* Function prototypes */
+bool loadPolicy(Policy *policy, const char *path);
+bool savePolicy(const Policy *policy, const char *path);
+bool randomPolicy(Policy *policy, uint64_t seed);
+void freePolicy(Policy *policy);
+void encodePolicyInput(const Game *game, float *input);
+void policyForwardBatch(const Policy *policy, const float *inputs, int count,
+                        float *outputs);
+void policyChooseMoves(const Policy *policy, const Game *const *games,
+                       int count, int *directions);
+int policyChooseMove(const Policy *policy, const Game *game);
+const char *policyKernelName(void);
+
+#endif /* POLICY_H */
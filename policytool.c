@@ -0,0 +1,153 @@
+/**
+ * Snake Game - Policy Tool (snake-policy)
+ *
+ * Helper for the neural network policy:
+ *   snake-policy --init FILE [--seed N]
+ *       Write a randomly initialised network to FILE.
+ *   snake-policy --bench FILE [--games N] [--ticks N]
+ *       Run N games side by side (a small vectorized environment), decide
+ *       all of their moves with one batched forward pass per tick, and report
+ *       the time per decision, both batched and one game at a time.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "game.h"
+#include "policy.h"
+#include "clock.h"
+
+#define BENCH_MAX_GAMES 4096
+
+/* Function prototypes */
+int benchPolicy(const Policy *policy, int games, int ticks);
+void usage(const char *program);
+
+/* Main function - entry point of the program */
+int main(int argc, char *argv[]) {
+    const char *initFile = NULL;
+    const char *benchFile = NULL;
+    uint64_t seed = (uint64_t)time(NULL);
+    int games = 256;
+    int ticks = 2000;
+    Policy policy;
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--init") == 0 && i + 1 < argc) {
+            initFile = argv[++i];
+        } else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            benchFile = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (initFile != NULL) {
+        if (!randomPolicy(&policy, seed) || !savePolicy(&policy, initFile)) {
+            fprintf(stderr, "Could not write %s\n", initFile);
+            return 1;
+        }
+        freePolicy(&policy);
+        printf("Wrote random policy to %s\n", initFile);
+        return 0;
+    }
+
+    if (benchFile != NULL) {
+        if (games < 1 || games > BENCH_MAX_GAMES || ticks < 1) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (!loadPolicy(&policy, benchFile)) {
+            fprintf(stderr, "Could not load policy from %s\n", benchFile);
+            return 1;
+        }
+        int status = benchPolicy(&policy, games, ticks);
+        freePolicy(&policy);
+        return status;
+    }
+
+    usage(argv[0]);
+    return 1;
+}
+
+/* Play 'games' games in lockstep for 'ticks' ticks, timing the decisions */
+int benchPolicy(const Policy *policy, int games, int ticks) {
+    static Game game[BENCH_MAX_GAMES];
+    static Arena arena[BENCH_MAX_GAMES];
+    static const Game *live[BENCH_MAX_GAMES];
+    static int direction[BENCH_MAX_GAMES];
+    uint64_t seed = 1;
+    long long decisions = 0;
+    long long food = 0;
+    long finished = 0;
+    double decideTime = 0.0;
+
+    for (int g = 0; g < games; g++) {
+        if (!arenaInit(&arena[g], GAME_ARENA_BYTES)) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+        initializeGame(&game[g], &arena[g], seed++);
+    }
+
+    for (int tick = 0; tick < ticks; tick++) {
+        for (int g = 0; g < games; g++) {
+            live[g] = &game[g];
+        }
+
+        /* One batched forward pass decides every game's move */
+        double start = secondsNow();
+        policyChooseMoves(policy, live, games, direction);
+        decideTime += secondsNow() - start;
+        decisions += games;
+
+        for (int g = 0; g < games; g++) {
+            turnSnake(&game[g].snake, direction[g]);
+            if (stepGame(&game[g])) {
+                food++;
+            }
+            /* Finished games restart at once, so the batch stays full */
+            if (game[g].gameOver) {
+                finished++;
+                arenaReset(&arena[g]);
+                initializeGame(&game[g], &arena[g], seed++);
+            }
+        }
+    }
+
+    /* The same decisions one game at a time, for the unbatched latency */
+    double single = secondsNow();
+    for (int i = 0; i < 10000; i++) {
+        policyChooseMove(policy, &game[i % games]);
+    }
+    single = (secondsNow() - single) / 10000;
+
+    printf("kernel %s, %d inputs, %d hidden units\n", policyKernelName(),
+           POLICY_FEATURES, POLICY_HIDDEN);
+    printf("batched:  %lld decisions in %.3f s, %.3f us/decision\n",
+           decisions, decideTime, decideTime * 1e6 / decisions);
+    printf("single:   %.3f us/decision\n", single * 1e6);
+    printf("games finished %ld, food eaten %lld\n", finished, food);
+
+    for (int g = 0; g < games; g++) {
+        arenaFree(&arena[g]);
+    }
+    return 0;
+}
+
+/* Print command line help */
+void usage(const char *program) {
+    fprintf(stderr, "Usage: %s --init FILE [--seed N]\n", program);
+    fprintf(stderr, "       %s --bench FILE [--games N] [--ticks N]\n", program);
+}
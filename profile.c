@@ -0,0 +1,220 @@
+/**
+ * Snake Game - Tick Profiler
+ *
+ * See profile.h. The counters form one perf event group, so they are
+ * scheduled onto the CPU together and a single read() returns all of them.
+ * A counter the CPU or the kernel does not offer is simply left out; if
+ * none can be opened (no PMU in a VM, or perf_event_paranoid too high) the
+ * profiler still measures time.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "profile.h"
+#include "clock.h"
+
+/* Empty begin/end pairs used to measure the profiler's own cost */
+#define CALIBRATION_PAIRS 1000
+
+/* The counters, in COUNTER_* order */
+static const struct {
+    uint64_t config;
+    const char *name;
+} counterEvents[PROFILE_COUNTERS] = {
+    { PERF_COUNT_HW_CPU_CYCLES, "cycles" },
+    { PERF_COUNT_HW_INSTRUCTIONS, "instructions" },
+    { PERF_COUNT_HW_CACHE_REFERENCES, "cache-references" },
+    { PERF_COUNT_HW_CACHE_MISSES, "cache-misses" },
+    { PERF_COUNT_HW_BRANCH_INSTRUCTIONS, "branches" },
+    { PERF_COUNT_HW_BRANCH_MISSES, "branch-misses" },
+};
+
+static const char *phaseNames[PROFILE_PHASES] = {
+    "moveSnake", "checkCollision", "placeFood", "render"
+};
+
+/* glibc has no wrapper for perf_event_open() */
+static int perfEventOpen(struct perf_event_attr *attr, int groupFd) {
+    return (int)syscall(SYS_perf_event_open, attr, 0, -1, groupFd, 0);
+}
+
+/* Read every counter of the group in one system call */
+static void readCounters(TickProfiler *profiler, uint64_t *counts) {
+    /* PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_RUNNING layout:
+     * number of counters, time running, then one value per counter */
+    uint64_t buffer[2 + PROFILE_COUNTERS];
+
+    memset(counts, 0, PROFILE_COUNTERS * sizeof(uint64_t));
+    if (profiler->groupFd < 0 ||
+        read(profiler->groupFd, buffer, sizeof(buffer)) < (ssize_t)(2 * sizeof(uint64_t))) {
+        return;
+    }
+    profiler->running = buffer[1];
+    for (int c = 0; c < PROFILE_COUNTERS; c++) {
+        if (profiler->slot[c] >= 0 && profiler->slot[c] < (int)buffer[0]) {
+            counts[c] = buffer[2 + profiler->slot[c]];
+        }
+    }
+}
+
+/* Open the counters and measure the cost of a measurement */
+void openTickProfiler(TickProfiler *profiler) {
+    memset(profiler, 0, sizeof(TickProfiler));
+    profiler->groupFd = -1;
+    profiler->phase = -1;
+
+    for (int c = 0; c < PROFILE_COUNTERS; c++) {
+        struct perf_event_attr attr;
+
+        profiler->fd[c] = -1;
+        profiler->slot[c] = -1;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = counterEvents[c].config;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.disabled = profiler->groupFd < 0;  // The leader starts the group
+
+        int fd = perfEventOpen(&attr, profiler->groupFd);
+        if (fd < 0) {
+            if (profiler->error[0] == '\0') {
+                snprintf(profiler->error, sizeof(profiler->error), "%s: %s",
+                         counterEvents[c].name, strerror(errno));
+            }
+            continue;
+        }
+        if (profiler->groupFd < 0) {
+            profiler->groupFd = fd;
+        }
+        profiler->fd[c] = fd;
+        profiler->slot[c] = profiler->opened++;
+    }
+
+    if (profiler->groupFd >= 0) {
+        ioctl(profiler->groupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(profiler->groupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    /* PROFILE_PHASES stands for the overhead slot */
+    for (int i = 0; i < CALIBRATION_PAIRS; i++) {
+        profileBegin(profiler, PROFILE_PHASES);
+        profileEnd(profiler);
+    }
+}
+
+/* Start measuring a phase (a phase already running keeps going) */
+void profileBegin(TickProfiler *profiler, int phase) {
+    if (profiler->phase >= 0) {
+        return;
+    }
+    profiler->phase = phase;
+    profiler->startNs = nowNs();
+    readCounters(profiler, profiler->start);
+}
+
+/* Stop measuring and add the phase's counts to its totals */
+void profileEnd(TickProfiler *profiler) {
+    uint64_t counts[PROFILE_COUNTERS];
+
+    if (profiler->phase < 0) {
+        return;
+    }
+    readCounters(profiler, counts);
+    long long ns = nowNs() - profiler->startNs;
+
+    PhaseTotals *totals = profiler->phase < PROFILE_PHASES ?
+        &profiler->phases[profiler->phase] : &profiler->overhead;
+    totals->calls++;
+    totals->ns += ns;
+    for (int c = 0; c < PROFILE_COUNTERS; c++) {
+        totals->counts[c] += counts[c] - profiler->start[c];
+    }
+    profiler->phase = -1;
+}
+
+/* A phase's total minus the profiler's own cost, never below zero */
+static double netCount(const TickProfiler *profiler, const PhaseTotals *totals,
+                       int counter) {
+    const PhaseTotals *overhead = &profiler->overhead;
+    double total = counter < 0 ? (double)totals->ns : (double)totals->counts[counter];
+    double cost = counter < 0 ? (double)overhead->ns : (double)overhead->counts[counter];
+
+    if (overhead->calls > 0) {
+        total -= cost / overhead->calls * totals->calls;
+    }
+    return total > 0 ? total : 0;
+}
+
+/* Print "-" for a ratio whose counters are missing or empty */
+static void printRatio(FILE *out, const TickProfiler *profiler, const PhaseTotals *totals,
+                       int top, int bottom, double scale) {
+    double denominator = netCount(profiler, totals, bottom);
+
+    if (profiler->slot[top] < 0 || profiler->slot[bottom] < 0 || denominator <= 0) {
+        fprintf(out, " %12s", "-");
+        return;
+    }
+    fprintf(out, " %12.2f", netCount(profiler, totals, top) * scale / denominator);
+}
+
+/* Print time, IPC and miss rates per phase */
+void printTickProfile(const TickProfiler *profiler, FILE *out) {
+    bool counters = profiler->opened > 0 && profiler->running > 0;
+
+    fprintf(out, "\nTick profile (profiler cost of %.0f ns per phase taken off)\n",
+            profiler->overhead.calls ? (double)profiler->overhead.ns / profiler->overhead.calls : 0.0);
+    if (profiler->opened == 0) {
+        fprintf(out, "Hardware counters unavailable (%s), times only\n", profiler->error);
+    } else if (!counters) {
+        fprintf(out, "Hardware counters opened but never scheduled, times only\n");
+    } else if (profiler->error[0] != '\0') {
+        fprintf(out, "Some counters unavailable (%s)\n", profiler->error);
+    }
+#ifndef TICK_PROFILE
+    fprintf(out, "Core phases not instrumented in this build (use make snake-profile)\n");
+#endif
+
+    fprintf(out, "%-15s %10s %10s", "phase", "calls", "ns/call");
+    if (counters) {
+        fprintf(out, " %12s %12s %12s %12s", "IPC", "cache miss%", "miss/kinst", "branch miss%");
+    }
+    fprintf(out, "\n");
+
+    for (int p = 0; p < PROFILE_PHASES; p++) {
+        const PhaseTotals *totals = &profiler->phases[p];
+        fprintf(out, "%-15s %10lld", phaseNames[p], totals->calls);
+        if (totals->calls == 0) {
+            fprintf(out, " %10s\n", "-");
+            continue;
+        }
+        fprintf(out, " %10.0f", netCount(profiler, totals, -1) / totals->calls);
+        if (counters) {
+            printRatio(out, profiler, totals, COUNTER_INSTRUCTIONS, COUNTER_CYCLES, 1.0);
+            printRatio(out, profiler, totals, COUNTER_CACHE_MISSES, COUNTER_CACHE_REFS, 100.0);
+            printRatio(out, profiler, totals, COUNTER_CACHE_MISSES, COUNTER_INSTRUCTIONS, 1000.0);
+            printRatio(out, profiler, totals, COUNTER_BRANCH_MISSES, COUNTER_BRANCHES, 100.0);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+/* Close the counters */
+void closeTickProfiler(TickProfiler *profiler) {
+    for (int c = 0; c < PROFILE_COUNTERS; c++) {
+        if (profiler->fd[c] >= 0) {
+            close(profiler->fd[c]);
+            profiler->fd[c] = -1;
+        }
+    }
+    profiler->groupFd = -1;
+    profiler->opened = 0;
+}
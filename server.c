@@ -0,0 +1,879 @@
+/**
+ * Snake Game - Game Server (snake-server)
+ *
+ * Hosts many real-time games on a handful of threads (see snake_net.h for
+ * the protocol). Each worker thread runs one epoll loop that multiplexes
+ * its listening socket, its client connections and its games, and sleeps
+ * until some game is due or a client sends something. The games' ticks are
+ * kept in a hashed timer wheel in user space (timerwheel.h), so a thread
+ * has one timerfd, armed for the next game that is due, however many games
+ * it runs. With --timers fd every game gets a timerfd of its own instead,
+ * which is simpler but costs a kernel timer and an epoll event per tick.
+ *
+ * The workers share nothing. Each has its own listening socket on the same
+ * port (SO_REUSEPORT lets the kernel spread connections over them), and its
+ * own pools of connections and games, set up once at startup and reused, so
+ * a game's tick never allocates. A connection and all its games live on
+ * the same worker.
+ *
+ * Lines are not written as they are made. They are appended to their
+ * connection's output buffer, and every connection with output is written
+ * once when the batch of events is done, so the hundreds of games of one
+ * connection that tick together go out in one write() rather than one
+ * each. With --writes line every line is written at once instead.
+ *
+ * Games and connections that close while a batch of events is being
+ * handled are only put back in their pools once the batch is done, because
+ * later events in the same batch may still point at them.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include "game.h"
+#include "snake_net.h"
+#include "timerwheel.h"
+#include "clock.h"
+
+/* Server Limits */
+#define SERVER_MAX_THREADS   64
+#define SERVER_EVENTS        256     // epoll events handled per wakeup
+#define CONNECTION_IN_BYTES  4096    // Unfinished command lines
+#define CONNECTION_OUT_BYTES 65536   // Output a slow client has not taken yet
+
+/* What an epoll event points at */
+#define HANDLE_LISTEN     0
+#define HANDLE_CONNECTION 1
+#define HANDLE_GAME       2  // A game's own timerfd (--timers fd)
+#define HANDLE_CLOCK      3  // The worker's timerfd for the timer wheel
+
+typedef struct {
+    int kind;
+    int fd;
+} Handle;
+
+typedef struct Connection Connection;
+
+/* One hosted game */
+typedef struct Session {
+    Handle handle;               // The game's timerfd (must stay first)
+    TimerEntry timer;            // Its place in the timer wheel
+    int tickMs;
+    uint32_t id;                 // Index in the worker's pool
+    Connection *owner;
+    struct Session *next;        // The owner's games, or a free list
+    struct Session *prev;
+    Game game;
+    Arena arena;                 // Made on first use, then reused
+    int turn;                    // Heading asked for since the last tick, or -1
+} Session;
+
+/* One client */
+struct Connection {
+    Handle handle;               // The socket (must stay first)
+    Connection *next;            // Free list
+    Session *games;              // Games started on this connection
+    Connection *nextPending;     // The worker's list of connections to write
+    bool pending;                // On that list
+    bool waiting;                // Socket full: waiting for EPOLLOUT
+    bool closing;
+    int inLength;
+    int outLength;
+    char in[CONNECTION_IN_BYTES];
+    char out[CONNECTION_OUT_BYTES];
+};
+
+/* Counters a worker publishes for the main thread */
+typedef struct {
+    long long ticks;             // Game moves made
+    long long overruns;          // Ticks that came due before the last was handled
+    long long frames;            // Lines sent
+    long long writes;            // write() calls made
+    long long started;           // Games started
+    long long live;              // Games running now
+    long long connections;       // Clients connected now
+} ServerStats;
+
+/* One thread with its own event loop */
+typedef struct {
+    int index;
+    pthread_t thread;
+    int epollFd;
+    Handle listen;
+    uint64_t rng;                // Seeds for new games
+
+    bool useWheel;               // Games tick from the wheel, not their own timerfds
+    TimerWheel *wheel;
+    Handle clock;                // Fires when the wheel's next slot is due
+    uint64_t armedFor;           // Time the clock is set for, 0 if not set
+
+    Session *sessions;
+    int maxGames;
+    Session *freeSessions;
+    Session *closedSessions;     // Freed at the end of the event batch
+
+    Connection *connections;
+    int maxConnections;
+    Connection *freeConnections;
+    Connection *closedConnections;
+    bool batchWrites;            // Write each connection once per batch
+    Connection *pendingWrites;   // Connections with output made this batch
+
+    ServerStats stats;           // Owned by the worker
+    ServerStats published;       // Copy the main thread may read
+} Worker;
+
+static volatile sig_atomic_t stopRequested = 0;
+
+/* Function prototypes */
+bool startWorker(Worker *worker, int port);
+void *workerThread(void *arg);
+void acceptConnections(Worker *worker);
+void readConnection(Worker *worker, Connection *connection);
+void handleLine(Worker *worker, Connection *connection, char *line);
+void startGame(Worker *worker, Connection *connection, int tickMs);
+void tickGame(Worker *worker, Session *session);
+void tickWheel(Worker *worker);
+void stepSession(Worker *worker, Session *session, uint64_t steps);
+void armClock(Worker *worker);
+void sendLine(Worker *worker, Connection *connection, const char *text, int length);
+void flushConnection(Worker *worker, Connection *connection);
+void flushPending(Worker *worker);
+void endGame(Worker *worker, Session *session);
+void closeConnection(Worker *worker, Connection *connection);
+void releaseClosed(Worker *worker);
+void publishStats(Worker *worker);
+void readStats(Worker *workers, int threads, ServerStats *total);
+void onSignal(int signal);
+uint64_t millisecondsNow(void);
+void usage(const char *program);
+
+/* Main function - entry point of the program */
+int main(int argc, char *argv[]) {
+    static Worker workers[SERVER_MAX_THREADS];
+    int port = SNAKE_NET_DEFAULT_PORT;
+    int threads = 4;
+    int maxGames = 8192;
+    int maxConnections = 1024;
+    double seconds = 0;
+    double reportSeconds = 5;
+    bool useWheel = true;
+    bool batchWrites = true;
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-games") == 0 && i + 1 < argc) {
+            maxGames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-connections") == 0 && i + 1 < argc) {
+            maxConnections = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+            reportSeconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--timers") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "wheel") == 0 || strcmp(argv[i], "fd") == 0) {
+                useWheel = strcmp(argv[i], "wheel") == 0;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--writes") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "batch") == 0 || strcmp(argv[i], "line") == 0) {
+                batchWrites = strcmp(argv[i], "batch") == 0;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1 || threads > SERVER_MAX_THREADS || maxGames < 1 || maxConnections < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    /* Every client holds a socket, and without the wheel every game a timerfd */
+    struct rlimit files;
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0) {
+        files.rlim_cur = files.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &files);
+        long long needed = (long long)threads *
+                           ((useWheel ? 0 : maxGames) + maxConnections + 3) + 16;
+        if ((long long)files.rlim_cur < needed) {
+            fprintf(stderr, "Warning: %llu file descriptors allowed, up to %lld needed\n",
+                    (unsigned long long)files.rlim_cur, needed);
+        }
+    }
+
+    /* A client that goes away is noticed through write() errors instead */
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    for (int t = 0; t < threads; t++) {
+        workers[t].index = t;
+        workers[t].maxGames = maxGames;
+        workers[t].maxConnections = maxConnections;
+        workers[t].useWheel = useWheel;
+        workers[t].batchWrites = batchWrites;
+        if (!startWorker(&workers[t], port)) {
+            return 1;
+        }
+    }
+    printf("Serving on port %d with %d threads (up to %d games each, %s, %s)\n",
+           port, threads, maxGames, useWheel ? "timer wheel" : "a timerfd per game",
+           batchWrites ? "batched writes" : "a write per line");
+    fflush(stdout);
+
+    /* Report now and then until asked to stop */
+    double start = secondsNow();
+    double lastReport = start;
+    ServerStats last;
+    memset(&last, 0, sizeof(last));
+    while (!stopRequested && (seconds <= 0 || secondsNow() - start < seconds)) {
+        usleep(100000);
+        double now = secondsNow();
+        if (reportSeconds > 0 && now - lastReport >= reportSeconds) {
+            ServerStats total;
+            readStats(workers, threads, &total);
+            double span = now - lastReport;
+            printf("%lld games, %lld clients: %.0f ticks/s, %.0f lines/s, "
+                   "%.0f writes/s, %lld overruns\n",
+                   total.live, total.connections, (total.ticks - last.ticks) / span,
+                   (total.frames - last.frames) / span, (total.writes - last.writes) / span,
+                   total.overruns - last.overruns);
+            fflush(stdout);
+            last = total;
+            lastReport = now;
+        }
+    }
+
+    stopRequested = 1;
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+    }
+    ServerStats total;
+    readStats(workers, threads, &total);
+    printf("Done: %lld games started, %lld ticks, %lld lines in %lld writes, %lld overruns\n",
+           total.started, total.ticks, total.frames, total.writes, total.overruns);
+    return 0;
+}
+
+/* Set up a worker's socket, pools and event loop, and start its thread */
+bool startWorker(Worker *worker, int port) {
+    int one = 1;
+    struct sockaddr_in address;
+
+    worker->rng = (uint64_t)time(NULL) * 0x9E3779B97F4A7C15ULL + worker->index + 1;
+    worker->sessions = calloc(worker->maxGames, sizeof(Session));
+    worker->connections = calloc(worker->maxConnections, sizeof(Connection));
+    if (worker->sessions == NULL || worker->connections == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return false;
+    }
+    for (int i = worker->maxGames - 1; i >= 0; i--) {
+        worker->sessions[i].id = (uint32_t)i;
+        worker->sessions[i].handle.kind = HANDLE_GAME;
+        worker->sessions[i].handle.fd = -1;
+        worker->sessions[i].next = worker->freeSessions;
+        worker->freeSessions = &worker->sessions[i];
+    }
+    for (int i = worker->maxConnections - 1; i >= 0; i--) {
+        worker->connections[i].handle.kind = HANDLE_CONNECTION;
+        worker->connections[i].handle.fd = -1;
+        worker->connections[i].next = worker->freeConnections;
+        worker->freeConnections = &worker->connections[i];
+    }
+
+    /* Every worker listens on the same port */
+    worker->listen.kind = HANDLE_LISTEN;
+    worker->listen.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (worker->listen.fd < 0) {
+        perror("socket");
+        return false;
+    }
+    setsockopt(worker->listen.fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(worker->listen.fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons((uint16_t)port);
+    if (bind(worker->listen.fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(worker->listen.fd, 1024) != 0) {
+        fprintf(stderr, "Could not listen on port %d: %s\n", port, strerror(errno));
+        return false;
+    }
+
+    worker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event = { .events = EPOLLIN, .data.ptr = &worker->listen };
+    if (worker->epollFd < 0 ||
+        epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, worker->listen.fd, &event) != 0) {
+        perror("epoll");
+        return false;
+    }
+
+    /* The wheel's clock is armed whenever the wheel has games in it */
+    if (worker->useWheel) {
+        worker->wheel = malloc(sizeof(TimerWheel));
+        worker->clock.kind = HANDLE_CLOCK;
+        worker->clock.fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        struct epoll_event tick = { .events = EPOLLIN, .data.ptr = &worker->clock };
+        if (worker->wheel == NULL || worker->clock.fd < 0 ||
+            epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, worker->clock.fd, &tick) != 0) {
+            fprintf(stderr, "Could not set up the timer wheel\n");
+            return false;
+        }
+        timerWheelInit(worker->wheel, millisecondsNow());
+    }
+    if (pthread_create(&worker->thread, NULL, workerThread, worker) != 0) {
+        fprintf(stderr, "Could not start worker thread %d\n", worker->index);
+        return false;
+    }
+    return true;
+}
+
+/* The event loop: wait for sockets and timers, handle what is ready */
+void *workerThread(void *arg) {
+    Worker *worker = arg;
+    struct epoll_event events[SERVER_EVENTS];
+
+    while (!stopRequested) {
+        /* The timeout only matters for noticing a stop request */
+        int count = epoll_wait(worker->epollFd, events, SERVER_EVENTS, 200);
+        for (int e = 0; e < count; e++) {
+            Handle *handle = events[e].data.ptr;
+
+            if (handle->kind == HANDLE_LISTEN) {
+                acceptConnections(worker);
+            } else if (handle->kind == HANDLE_CLOCK) {
+                tickWheel(worker);
+            } else if (handle->kind == HANDLE_GAME) {
+                Session *session = (Session *)handle;
+                if (session->owner != NULL) {
+                    tickGame(worker, session);
+                }
+            } else {
+                Connection *connection = (Connection *)handle;
+                if (connection->closing) {
+                    continue;
+                }
+                if (events[e].events & (EPOLLERR | EPOLLHUP)) {
+                    closeConnection(worker, connection);
+                    continue;
+                }
+                if (events[e].events & EPOLLOUT) {
+                    flushConnection(worker, connection);
+                }
+                if ((events[e].events & EPOLLIN) && !connection->closing) {
+                    readConnection(worker, connection);
+                }
+            }
+        }
+        flushPending(worker);
+        releaseClosed(worker);
+        armClock(worker);
+        publishStats(worker);
+    }
+
+    /* Shut down: close every client and game */
+    for (int i = 0; i < worker->maxConnections; i++) {
+        if (worker->connections[i].handle.fd >= 0 && !worker->connections[i].closing) {
+            closeConnection(worker, &worker->connections[i]);
+        }
+    }
+    releaseClosed(worker);
+    publishStats(worker);
+    close(worker->listen.fd);
+    if (worker->useWheel) {
+        close(worker->clock.fd);
+        free(worker->wheel);
+    }
+    close(worker->epollFd);
+    return NULL;
+}
+
+/* Take every waiting client */
+void acceptConnections(Worker *worker) {
+    for (;;) {
+        int fd = accept4(worker->listen.fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        Connection *connection = worker->freeConnections;
+        if (connection == NULL) {
+            close(fd);  // Full: the client sees the connection close
+            continue;
+        }
+
+        /* Frames are small and should go out at once */
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        struct epoll_event event = { .events = EPOLLIN, .data.ptr = connection };
+        if (epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+        worker->freeConnections = connection->next;
+        connection->handle.fd = fd;
+        connection->next = NULL;
+        connection->games = NULL;
+        connection->pending = false;
+        connection->waiting = false;
+        connection->closing = false;
+        connection->inLength = 0;
+        connection->outLength = 0;
+        worker->stats.connections++;
+    }
+}
+
+/* Read what the client sent and run every complete line */
+void readConnection(Worker *worker, Connection *connection) {
+    for (;;) {
+        ssize_t got = read(connection->handle.fd, connection->in + connection->inLength,
+                           CONNECTION_IN_BYTES - connection->inLength);
+        if (got == 0 || (got < 0 && errno != EAGAIN && errno != EINTR)) {
+            closeConnection(worker, connection);
+            return;
+        }
+        if (got < 0) {
+            return;
+        }
+        connection->inLength += (int)got;
+
+        /* Run the complete lines, keep the rest for the next read */
+        int start = 0;
+        for (int i = 0; i < connection->inLength && !connection->closing; i++) {
+            if (connection->in[i] == '\n') {
+                connection->in[i] = '\0';
+                handleLine(worker, connection, connection->in + start);
+                start = i + 1;
+            }
+        }
+        if (connection->closing) {
+            return;
+        }
+        memmove(connection->in, connection->in + start, connection->inLength - start);
+        connection->inLength -= start;
+        if (connection->inLength == CONNECTION_IN_BYTES) {
+            closeConnection(worker, connection);  // A line that never ends
+            return;
+        }
+    }
+}
+
+/* Run one command line */
+void handleLine(Worker *worker, Connection *connection, char *line) {
+    char command[16];
+    char direction = 0;
+    unsigned id = 0;
+    int tickMs = SNAKE_NET_DEFAULT_TICK;
+    int fields = sscanf(line, "%15s %u %c", command, &id, &direction);
+
+    if (fields <= 0) {
+        return;  // Blank line
+    }
+    if (strcmp(command, "new") == 0) {
+        if (fields >= 2) {
+            tickMs = (int)id;
+        }
+        startGame(worker, connection, tickMs);
+        return;
+    }
+
+    if (strcmp(command, "turn") != 0 && strcmp(command, "end") != 0) {
+        sendLine(worker, connection, "error unknown command\n", 22);
+        return;
+    }
+
+    /* The other commands name one of this connection's games */
+    Session *session = fields >= 2 && id < (unsigned)worker->maxGames ?
+        &worker->sessions[id] : NULL;
+    if (session == NULL || session->owner != connection) {
+        char text[SNAKE_NET_MAX_LINE];
+        int length = snprintf(text, sizeof(text), "error no game %u\n", id);
+        sendLine(worker, connection, text, length);
+        return;
+    }
+    if (strcmp(command, "end") == 0) {
+        endGame(worker, session);
+        return;
+    }
+    const char *directions = "urdl";  // UP, RIGHT, DOWN, LEFT
+    const char *found = fields == 3 ? strchr(directions, direction) : NULL;
+    if (found == NULL || direction == '\0') {
+        sendLine(worker, connection, "error bad direction\n", 20);
+        return;
+    }
+    session->turn = (int)(found - directions);
+}
+
+/* Start a game ticking on its own timer */
+void startGame(Worker *worker, Connection *connection, int tickMs) {
+    Session *session = worker->freeSessions;
+    char text[SNAKE_NET_MAX_LINE];
+
+    if (tickMs < SNAKE_NET_MIN_TICK) {
+        tickMs = SNAKE_NET_MIN_TICK;
+    } else if (tickMs > SNAKE_NET_MAX_TICK) {
+        tickMs = SNAKE_NET_MAX_TICK;
+    }
+    if (session == NULL) {
+        sendLine(worker, connection, "error server full\n", 18);
+        return;
+    }
+    if (session->arena.base == NULL && !arenaInit(&session->arena, GAME_ARENA_BYTES)) {
+        sendLine(worker, connection, "error out of memory\n", 20);
+        return;
+    }
+
+    /* The first tick is one period from now, and the rest follow on a
+     * fixed schedule */
+    int timerFd = -1;
+    if (worker->useWheel) {
+        timerWheelAdd(worker->wheel, &session->timer, millisecondsNow() + tickMs);
+    } else {
+        timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        struct itimerspec period;
+        period.it_interval.tv_sec = tickMs / 1000;
+        period.it_interval.tv_nsec = (long)(tickMs % 1000) * 1000000L;
+        period.it_value = period.it_interval;
+        struct epoll_event event = { .events = EPOLLIN, .data.ptr = session };
+        if (timerFd < 0 || timerfd_settime(timerFd, 0, &period, NULL) != 0 ||
+            epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, timerFd, &event) != 0) {
+            if (timerFd >= 0) {
+                close(timerFd);
+            }
+            sendLine(worker, connection, "error no timer\n", 15);
+            return;
+        }
+    }
+
+    worker->freeSessions = session->next;
+    session->handle.fd = timerFd;
+    session->tickMs = tickMs;
+    session->owner = connection;
+    session->turn = -1;
+    session->prev = NULL;
+    session->next = connection->games;
+    if (connection->games != NULL) {
+        connection->games->prev = session;
+    }
+    connection->games = session;
+
+    worker->rng = worker->rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    arenaReset(&session->arena);
+    initializeGame(&session->game, &session->arena, worker->rng);
+    worker->stats.started++;
+    worker->stats.live++;
+
+    int length = snprintf(text, sizeof(text), "game %u %llu\n", session->id,
+                          (unsigned long long)worker->rng);
+    sendLine(worker, connection, text, length);
+}
+
+/* The game's own timerfd fired: move once for every tick that has come due */
+void tickGame(Worker *worker, Session *session) {
+    uint64_t expirations = 0;
+
+    if (read(session->handle.fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return;
+    }
+    worker->stats.overruns += (long long)expirations - 1;
+    stepSession(worker, session, expirations);
+}
+
+/* The wheel's clock fired: tick every game that is due, and put each back
+ * in the wheel for its next tick on the same fixed schedule */
+void tickWheel(Worker *worker) {
+    uint64_t expirations;
+    TimerEntry expired;
+
+    if (read(worker->clock.fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return;
+    }
+    worker->armedFor = 0;
+
+    uint64_t now = millisecondsNow();
+    timerListInit(&expired);
+    timerWheelAdvance(worker->wheel, now, &expired);
+
+    /* A game ended while ticking another is taken off this list too */
+    TimerEntry *entry;
+    while ((entry = timerListPop(&expired)) != NULL) {
+        Session *session = (Session *)((char *)entry - offsetof(Session, timer));
+        uint64_t steps = 1 + (now - entry->due) / session->tickMs;
+        worker->stats.overruns += (long long)steps - 1;
+        stepSession(worker, session, steps);
+        if (session->owner != NULL) {
+            timerWheelAdd(worker->wheel, &session->timer,
+                          entry->due + steps * session->tickMs);
+        }
+    }
+}
+
+/* Set the wheel's clock for the next slot with a game in it */
+void armClock(Worker *worker) {
+    uint64_t due;
+
+    if (!worker->useWheel || !timerWheelNextDue(worker->wheel, &due) ||
+        due == worker->armedFor) {
+        return;
+    }
+    struct itimerspec when;
+    memset(&when, 0, sizeof(when));
+    when.it_value.tv_sec = (time_t)(due / 1000);
+    when.it_value.tv_nsec = (long)(due % 1000) * 1000000L;
+    timerfd_settime(worker->clock.fd, TFD_TIMER_ABSTIME, &when, NULL);
+    worker->armedFor = due;
+}
+
+/* Move a game the given number of ticks and tell its client about each */
+void stepSession(Worker *worker, Session *session, uint64_t steps) {
+    char text[SNAKE_NET_MAX_LINE];
+
+    for (uint64_t t = 0; t < steps && session->owner != NULL; t++) {
+        Game *game = &session->game;
+        if (session->turn >= 0) {
+            turnSnake(&game->snake, session->turn);
+            session->turn = -1;
+        }
+        stepGame(game);
+        worker->stats.ticks++;
+
+        Point head = snakeSegment(&game->snake, 0);
+        int score = game->snake.size - INITIAL_SIZE;
+        int length = snprintf(text, sizeof(text), "tick %u %d %d %d %d %d %d",
+                              session->id, game->stats.ticks, score,
+                              head.x, head.y, game->food.x, game->food.y);
+        if (game->stats.ticks % SNAKE_NET_HASH_EVERY == 0) {
+            length += snprintf(text + length, sizeof(text) - length, " %016llx",
+                               (unsigned long long)gameHash(game));
+        }
+        text[length++] = '\n';
+        sendLine(worker, session->owner, text, length);
+
+        if (game->gameOver && session->owner != NULL) {
+            length = snprintf(text, sizeof(text), "over %u %d %d\n",
+                              session->id, score, game->won ? 1 : 0);
+            sendLine(worker, session->owner, text, length);
+            endGame(worker, session);
+        }
+    }
+}
+
+/* Send one line to a client. In batch mode it is buffered, and the
+ * connection is written once the batch of events is done. Otherwise it is
+ * written at once, and only what the socket cannot take right now is
+ * buffered until it can. */
+void sendLine(Worker *worker, Connection *connection, const char *text, int length) {
+    if (connection->closing) {
+        return;
+    }
+    worker->stats.frames++;
+    if (worker->batchWrites) {
+        /* A connection with very many games may fill its buffer in one batch */
+        if (connection->outLength + length > CONNECTION_OUT_BYTES && !connection->waiting) {
+            flushConnection(worker, connection);
+            if (connection->closing) {
+                return;
+            }
+        }
+        if (!connection->pending) {
+            connection->pending = true;
+            connection->nextPending = worker->pendingWrites;
+            worker->pendingWrites = connection;
+        }
+    } else if (connection->outLength == 0) {
+        ssize_t sent = write(connection->handle.fd, text, length);
+        worker->stats.writes++;
+        if (sent == length) {
+            return;
+        }
+        if (sent < 0 && errno != EAGAIN) {
+            closeConnection(worker, connection);
+            return;
+        }
+        if (sent > 0) {
+            text += sent;
+            length -= (int)sent;
+        }
+
+        /* Wake up when the socket has room again */
+        struct epoll_event event = { .events = EPOLLIN | EPOLLOUT, .data.ptr = connection };
+        epoll_ctl(worker->epollFd, EPOLL_CTL_MOD, connection->handle.fd, &event);
+        connection->waiting = true;
+    }
+    if (connection->outLength + length > CONNECTION_OUT_BYTES) {
+        closeConnection(worker, connection);  // The client has stopped reading
+        return;
+    }
+    memcpy(connection->out + connection->outLength, text, length);
+    connection->outLength += length;
+}
+
+/* Write out what was buffered; wait for EPOLLOUT if the socket is full */
+void flushConnection(Worker *worker, Connection *connection) {
+    if (connection->outLength == 0) {
+        return;
+    }
+    ssize_t sent = write(connection->handle.fd, connection->out, connection->outLength);
+    worker->stats.writes++;
+    if (sent < 0) {
+        if (errno != EAGAIN) {
+            closeConnection(worker, connection);
+            return;
+        }
+        sent = 0;
+    }
+    memmove(connection->out, connection->out + sent, connection->outLength - sent);
+    connection->outLength -= (int)sent;
+    if ((connection->outLength > 0) != connection->waiting) {
+        connection->waiting = connection->outLength > 0;
+        struct epoll_event event = {
+            .events = connection->waiting ? EPOLLIN | EPOLLOUT : EPOLLIN,
+            .data.ptr = connection
+        };
+        epoll_ctl(worker->epollFd, EPOLL_CTL_MOD, connection->handle.fd, &event);
+    }
+}
+
+/* Write every connection that was given lines during the batch. One that
+ * is waiting for room is written when EPOLLOUT says there is some. */
+void flushPending(Worker *worker) {
+    while (worker->pendingWrites != NULL) {
+        Connection *connection = worker->pendingWrites;
+        worker->pendingWrites = connection->nextPending;
+        connection->pending = false;
+        if (!connection->closing && !connection->waiting) {
+            flushConnection(worker, connection);
+        }
+    }
+}
+
+/* Stop a game; its slot is reused after this batch of events */
+void endGame(Worker *worker, Session *session) {
+    Connection *connection = session->owner;
+
+    if (connection == NULL) {
+        return;
+    }
+    if (session->prev != NULL) {
+        session->prev->next = session->next;
+    } else {
+        connection->games = session->next;
+    }
+    if (session->next != NULL) {
+        session->next->prev = session->prev;
+    }
+    if (worker->useWheel) {
+        timerWheelRemove(worker->wheel, &session->timer);
+    } else {
+        close(session->handle.fd);  // Also takes it out of the epoll set
+        session->handle.fd = -1;
+    }
+    session->owner = NULL;
+    session->next = worker->closedSessions;
+    worker->closedSessions = session;
+    worker->stats.live--;
+}
+
+/* Drop a client and all its games */
+void closeConnection(Worker *worker, Connection *connection) {
+    if (connection->closing) {
+        return;
+    }
+    connection->closing = true;
+    while (connection->games != NULL) {
+        endGame(worker, connection->games);
+    }
+    close(connection->handle.fd);
+    connection->next = worker->closedConnections;
+    worker->closedConnections = connection;
+    worker->stats.connections--;
+}
+
+/* Put what closed during the batch back into the pools */
+void releaseClosed(Worker *worker) {
+    while (worker->closedSessions != NULL) {
+        Session *session = worker->closedSessions;
+        worker->closedSessions = session->next;
+        session->next = worker->freeSessions;
+        worker->freeSessions = session;
+    }
+    while (worker->closedConnections != NULL) {
+        Connection *connection = worker->closedConnections;
+        worker->closedConnections = connection->next;
+        connection->handle.fd = -1;
+        connection->next = worker->freeConnections;
+        worker->freeConnections = connection;
+    }
+}
+
+/* Copy the counters where the main thread can read them */
+void publishStats(Worker *worker) {
+    long long *from = (long long *)&worker->stats;
+    long long *to = (long long *)&worker->published;
+    for (size_t i = 0; i < sizeof(ServerStats) / sizeof(long long); i++) {
+        __atomic_store_n(&to[i], from[i], __ATOMIC_RELAXED);
+    }
+}
+
+/* Add up the counters of all workers */
+void readStats(Worker *workers, int threads, ServerStats *total) {
+    long long *sum = (long long *)total;
+    memset(total, 0, sizeof(ServerStats));
+    for (int t = 0; t < threads; t++) {
+        long long *from = (long long *)&workers[t].published;
+        for (size_t i = 0; i < sizeof(ServerStats) / sizeof(long long); i++) {
+            sum[i] += __atomic_load_n(&from[i], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/* Ask the workers to finish */
+void onSignal(int signal) {
+    (void)signal;
+    stopRequested = 1;
+}
+
+/* Monotonic clock in milliseconds (the timer wheel's time) */
+uint64_t millisecondsNow(void) {
+    return (uint64_t)(nowNs() / 1000000);
+}
+
+/* Print command line help */
+void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --port N             TCP port (default %d)\n", SNAKE_NET_DEFAULT_PORT);
+    fprintf(stderr, "  --threads N          Worker threads (default 4)\n");
+    fprintf(stderr, "  --max-games N        Games per thread (default 8192)\n");
+    fprintf(stderr, "  --max-connections N  Clients per thread (default 1024)\n");
+    fprintf(stderr, "  --seconds N          Stop after N seconds (default: run until Ctrl-C)\n");
+    fprintf(stderr, "  --report N           Print the load every N seconds (default 5)\n");
+    fprintf(stderr, "  --timers wheel|fd    One timer wheel per thread (default), or a\n"
+                    "                       timerfd per game\n");
+    fprintf(stderr, "  --writes batch|line  Write each client once per batch of events\n"
+                    "                       (default), or every line at once\n");
+}
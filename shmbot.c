@@ -0,0 +1,294 @@
+/**
+ * Snake Game - Shared-Memory Bot Host
+ *
+ * See shmbot.h and snake_shm.h. A round trip is: publish the state under
+ * the seqlock, bump the turn word and wake the client, then wait for the
+ * reply word. The wait spins for a short while first, because a client
+ * that is already waiting usually answers within a few microseconds and a
+ * futex sleep would add a context switch to every move.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "shmbot.h"
+#include "snake_shm.h"
+#include "clock.h"
+
+/* How long to poll for a reply before sleeping on the futex */
+#define SHM_SPIN_NS 20000
+
+/* Compile-time checks: the handshake words sit on their own cache lines,
+ * and the game's Point can be copied straight into a SnakeBotPoint */
+typedef char shmTurnLine[offsetof(SnakeShmHeader, turn) == 64 ? 1 : -1];
+typedef char shmReplyLine[offsetof(SnakeShmHeader, reply) == 128 ? 1 : -1];
+typedef char shmStateLine[offsetof(SnakeShmHeader, sequence) == 192 ? 1 : -1];
+typedef char shmPointLayout[sizeof(Point) == sizeof(SnakeBotPoint) ? 1 : -1];
+
+/* Turn a nanosecond count into a relative futex timeout */
+static struct timespec relativeTimeout(long long ns) {
+    struct timespec timeout;
+    timeout.tv_sec = ns / 1000000000LL;
+    timeout.tv_nsec = ns % 1000000000LL;
+    return timeout;
+}
+
+/* Whether the region already called 'name' was left behind by a game that
+ * is gone. Anything else (a live game, or an object that is not a finished
+ * game region) is left alone and explained in 'error'. */
+static bool staleRegion(const char *name, char *error, size_t errorSize) {
+    struct stat info;
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        snprintf(error, errorSize, "shm_open %s: %s", name, strerror(errno));
+        return false;
+    }
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(SnakeShmHeader)) {
+        close(fd);
+        snprintf(error, errorSize, "%s already exists and is not a game region "
+                 "(remove /dev/shm%s if nothing uses it)", name, name);
+        return false;
+    }
+    const SnakeShmHeader *shm = mmap(NULL, sizeof(SnakeShmHeader), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED) {
+        snprintf(error, errorSize, "mmap %s: %s", name, strerror(errno));
+        return false;
+    }
+
+    uint32_t magic = __atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE);
+    pid_t owner = (pid_t)shm->gamePid;
+    munmap((void *)shm, sizeof(SnakeShmHeader));
+
+    if (magic != SNAKE_SHM_MAGIC || owner <= 0) {
+        snprintf(error, errorSize, "%s already exists and is not a game region "
+                 "(remove /dev/shm%s if nothing uses it)", name, name);
+        return false;
+    }
+    if (kill(owner, 0) == 0 || errno != ESRCH) {
+        snprintf(error, errorSize, "%s is in use by the game with pid %d", name, (int)owner);
+        return false;
+    }
+    return true;
+}
+
+/* Create the shared region and fill in its fixed header */
+bool openShmBot(ShmBot *bot, const char *name, long budgetNs,
+                char *error, size_t errorSize) {
+    int ringCapacity = BODY_MIN_CAPACITY;
+    size_t ringOffset = sizeof(SnakeShmHeader);
+    size_t gridOffset;
+
+    memset(bot, 0, sizeof(ShmBot));
+    snprintf(bot->name, sizeof(bot->name), "%s", name);
+    bot->budgetNs = budgetNs;
+
+    /* The ring must hold the longest possible snake: a full board plus the
+     * doubled tail of the move that filled it */
+    while (ringCapacity < PLAY_CELLS + 1) {
+        ringCapacity *= 2;
+    }
+    ringOffset = (ringOffset + 63) & ~(size_t)63;
+    gridOffset = ringOffset + ringCapacity * sizeof(SnakeBotPoint);
+    gridOffset = (gridOffset + 63) & ~(size_t)63;
+    bot->shmSize = gridOffset + GRID_WORDS * sizeof(uint64_t);
+
+    /* A region left behind by a crashed game is replaced; one that a
+     * running game still owns is not */
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        if (!staleRegion(name, error, errorSize)) {
+            return false;
+        }
+        shm_unlink(name);
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    if (fd < 0) {
+        snprintf(error, errorSize, "shm_open %s: %s", name, strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, (off_t)bot->shmSize) != 0) {
+        snprintf(error, errorSize, "ftruncate %s: %s", name, strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    void *memory = mmap(NULL, bot->shmSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        snprintf(error, errorSize, "mmap %s: %s", name, strerror(errno));
+        shm_unlink(name);
+        return false;
+    }
+
+    /* ftruncate() zero-fills, so only the non-zero fields need setting */
+    bot->shm = memory;
+    bot->shm->version = SNAKE_SHM_VERSION;
+    bot->shm->width = WIDTH;
+    bot->shm->height = HEIGHT;
+    bot->shm->ringOffset = (uint32_t)ringOffset;
+    bot->shm->ringCapacity = (uint32_t)ringCapacity;
+    bot->shm->gridOffset = (uint32_t)gridOffset;
+    bot->shm->gridWords = GRID_WORDS;
+    bot->shm->regionSize = (uint32_t)bot->shmSize;
+    bot->shm->gamePid = (uint32_t)getpid();
+    bot->shm->budgetNs = budgetNs;
+
+    /* The magic goes in last, so a client never sees a half-made header */
+    __atomic_store_n(&bot->shm->magic, SNAKE_SHM_MAGIC, __ATOMIC_RELEASE);
+    return true;
+}
+
+/* Wait until a client process has attached (timeoutMs <= 0 waits forever) */
+bool waitForShmClient(ShmBot *bot, int timeoutMs) {
+    long long deadline = nowNs() + (long long)timeoutMs * 1000000LL;
+
+    while (__atomic_load_n(&bot->shm->clientPid, __ATOMIC_ACQUIRE) == 0) {
+        if (timeoutMs <= 0) {
+            snake_shm_wait(&bot->shm->clientPid, 0, NULL);
+            continue;
+        }
+        long long left = deadline - nowNs();
+        if (left <= 0) {
+            return false;
+        }
+        struct timespec timeout = relativeTimeout(left);
+        snake_shm_wait(&bot->shm->clientPid, 0, &timeout);
+    }
+    return true;
+}
+
+/* Copy the game into the region. Only the changes since the last tick are
+ * written when the game moved exactly one step. */
+static void publishState(ShmBot *bot, const Game *game, uint64_t tick) {
+    SnakeShmHeader *shm = bot->shm;
+    SnakeBotPoint *ring = snake_shm_ring(shm);
+    const Snake *snake = &game->snake;
+    uint32_t mask = shm->ringCapacity - 1;
+    uint32_t sequence = shm->sequence;
+
+    /* Open the seqlock: readers that see an odd number retry */
+    __atomic_store_n(&shm->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    /* After one step the old head is the new second segment */
+    Point neck = snakeSegment(snake, 1);
+    SnakeBotPoint oldHead = ring[shm->ringHead & mask];
+    if (bot->synced && tick == bot->lastTick + 1 &&
+        oldHead.x == neck.x && oldHead.y == neck.y) {
+        /* A new head in front, and the tail slot rewritten since eating
+         * duplicates the tail instead of keeping the old one */
+        Point head = snakeSegment(snake, 0);
+        Point tail = snakeSegment(snake, snake->size - 1);
+        int32_t ringHead = (shm->ringHead - 1) & mask;
+        ring[ringHead].x = head.x;
+        ring[ringHead].y = head.y;
+        ring[(ringHead + snake->size - 1) & mask].x = tail.x;
+        ring[(ringHead + snake->size - 1) & mask].y = tail.y;
+        shm->ringHead = ringHead;
+    } else {
+        for (int i = 0; i < snake->size; i++) {
+            Point segment = snakeSegment(snake, i);
+            ring[i].x = segment.x;
+            ring[i].y = segment.y;
+        }
+        shm->ringHead = 0;
+        bot->synced = true;
+    }
+    memcpy(snake_shm_grid(shm), snake->occupied, GRID_WORDS * sizeof(uint64_t));
+
+    shm->size = snake->size;
+    shm->direction = snake->direction;
+    shm->food.x = game->food.x;
+    shm->food.y = game->food.y;
+    shm->tick = tick;
+    shm->gameOver = game->gameOver;
+    shm->score = snake->size - INITIAL_SIZE;
+    bot->lastTick = tick;
+
+    /* Close the seqlock */
+    __atomic_store_n(&shm->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+/* Publish the game, ask the client for a move and wait for the answer */
+int shmBotChooseMove(ShmBot *bot, const Game *game, uint64_t tick) {
+    SnakeShmHeader *shm = bot->shm;
+    int direction = game->snake.direction;
+
+    publishState(bot, game, tick);
+
+    long long start = nowNs();
+    uint32_t turn = shm->turn + 1;
+    __atomic_store_n(&shm->turn, turn, __ATOMIC_RELEASE);
+    snake_shm_wake(&shm->turn);
+
+    /* Spin briefly, then sleep on the reply word until the budget runs out */
+    bool answered = false;
+    for (;;) {
+        uint32_t reply = __atomic_load_n(&shm->reply, __ATOMIC_ACQUIRE);
+        if (reply == turn) {
+            answered = true;
+            break;
+        }
+        long long elapsed = nowNs() - start;
+        if (bot->budgetNs > 0 && elapsed >= bot->budgetNs) {
+            break;
+        }
+        if (elapsed < SHM_SPIN_NS) {
+            continue;
+        }
+        if (bot->budgetNs > 0) {
+            struct timespec timeout = relativeTimeout(bot->budgetNs - elapsed);
+            snake_shm_wait(&shm->reply, reply, &timeout);
+        } else {
+            snake_shm_wait(&shm->reply, reply, NULL);
+        }
+    }
+    long long elapsed = nowNs() - start;
+
+    bot->calls++;
+    bot->totalSeconds += elapsed / 1e9;
+    if (elapsed / 1e9 > bot->worstSeconds) {
+        bot->worstSeconds = elapsed / 1e9;
+    }
+
+    /* A late or invalid answer is ignored: the snake keeps going */
+    if (!answered) {
+        bot->lateCalls++;
+        return direction;
+    }
+    int move = __atomic_load_n(&shm->move, __ATOMIC_RELAXED);
+    if (move < UP || move > LEFT) {
+        return direction;
+    }
+    return move;
+}
+
+/* Print the round-trip times */
+void printShmBotStats(const ShmBot *bot) {
+    if (bot->shm == NULL) {
+        return;
+    }
+    printf("Bot on %s: %ld moves, %.2f us average round trip, %.2f us worst, "
+           "%ld late\n", bot->name, bot->calls,
+           bot->calls ? bot->totalSeconds * 1e6 / bot->calls : 0.0,
+           bot->worstSeconds * 1e6, bot->lateCalls);
+}
+
+/* Tell the client the game is over and remove the region */
+void closeShmBot(ShmBot *bot) {
+    if (bot->shm != NULL) {
+        __atomic_store_n(&bot->shm->closed, 1, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&bot->shm->turn, 1, __ATOMIC_RELEASE);
+        snake_shm_wake(&bot->shm->turn);
+        munmap(bot->shm, bot->shmSize);
+        shm_unlink(bot->name);
+    }
+    memset(bot, 0, sizeof(ShmBot));
+}
@@ -0,0 +1,47 @@
+/**
+ * Snake Game - Shared-Memory Bot Host
+ *
+ * The game's side of snake_shm.h: creates the shared region, publishes the
+ * game state each tick and waits (up to the move budget) for the external
+ * process to answer.
+ *
+ * Publishing is incremental. The region keeps its own body ring, and in the
+ * usual case of one step per tick only the new head and the tail entry are
+ * written, plus the small occupancy grid. The full body is copied only for
+ * the first tick.
+ */
+
+#ifndef SHMBOT_H
+#define SHMBOT_H
+
+#include "game.h"
+
+/* The region itself is described in snake_shm.h, which needs _GNU_SOURCE */
+struct SnakeShmHeader;
+
+#define SHM_BOT_DEFAULT_NAME "/snake-bot"  // Same as SNAKE_SHM_DEFAULT_NAME
+
+/* Game-side state of the shared-memory bot */
+typedef struct {
+    struct SnakeShmHeader *shm;  // The mapped region
+    size_t shmSize;
+    char name[64];         // Shared memory object name, e.g. /snake-bot
+    long budgetNs;         // Time the client gets per move
+    bool synced;           // The shared ring matches the game
+    uint64_t lastTick;     // Tick of the last publish
+
+    long calls;            // Statistics
+    long lateCalls;
+    double totalSeconds;
+    double worstSeconds;
+} ShmBot;
+
+/* Function prototypes */
+bool openShmBot(ShmBot *bot, const char *name, long budgetNs,
+                char *error, size_t errorSize);
+bool waitForShmClient(ShmBot *bot, int timeoutMs);
+int shmBotChooseMove(ShmBot *bot, const Game *game, uint64_t tick);
+void printShmBotStats(const ShmBot *bot);
+void closeShmBot(ShmBot *bot);
+
+#endif /* SHMBOT_H */
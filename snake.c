@@ -13,28 +13,40 @@
  *   D/→: Move Right
  *   P: Pause Game
  *   Q: Quit Game
+ *
+ * Run with --ai NAME to watch any bot in the registry (see bots.h) play
+ * instead: --ai mcts for the Monte Carlo tree search AI, --ai heuristic for
+ * the cheap heuristic AI (weights from snake-train can be loaded with
+ * --weights FILE), --ai policy --policy FILE for the neural network policy,
+ * --ai plugin --plugin FILE.so for a bot loaded from a shared library (see
+ * snake_bot.h), and so on. --ai shm is for a bot running in another process
+ * (see snake_shm.h and examples/shm_client.c).
+ * --latency measures how long a keypress takes to reach the screen (see
+ * latency.h). --profile reports the time, IPC and cache misses of each phase of a tick
+ * when the game ends (see profile.h; build snake-profile for the full set).
  * 
- * Compile with: gcc -o snake snake.c -lcurses
- * Or use the provided Makefile: make
+ * Compile with: make
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include <time.h>
 #include <unistd.h>
+#include <poll.h>
 #include <curses.h>
+#include "game.h"
+#include "bots.h"
+#include "shmbot.h"
+#include "profile.h"
+#include "latency.h"
+#include "input.h"
 
-/* Game Constants */
-#define WIDTH 30      // Width of the game board
-#define HEIGHT 20     // Height of the game board
-#define INITIAL_SIZE 3  // Initial size of the snake
-
-/* Direction Constants */
-#define UP 0
-#define RIGHT 1
-#define DOWN 2
-#define LEFT 3
+/* Timing Constants */
+#define TICK_MS 100          // Length of one game tick in milliseconds
+#define AI_BUDGET_MS 80      // Thinking time the AI gets out of each tick
+#define MAX_KEYS_PER_READ 16 // Keys decoded from one read of the terminal
 
 /* Color Pair IDs */
 #define COLOR_PAIR_BORDER 1  // Border color pair
@@ -50,47 +62,133 @@
 #define EMPTY ' '
 #define BORDER '#'
 
-/* Structure to represent a point on the game board */
-typedef struct {
-    int x;
-    int y;
-} Point;
-
-/* Structure to represent the snake */
-typedef struct {
-    Point body[WIDTH * HEIGHT]; // Maximum possible size
-    int size;                   // Current size
-    int direction;              // Current direction
-} Snake;
-
 /* Function prototypes */
-void initializeGame(Snake *snake, Point *food);
-void drawGame(Snake snake, Point food, bool paused);
-void moveSnake(Snake *snake);
-bool checkCollision(Snake snake);
-void placeFood(Snake snake, Point *food);
-bool eatFood(Snake *snake, Point *food);
-void handleInput(Snake *snake, bool *gameOver, bool *gamePaused);
-void endGame(int score);
+void drawGame(const Game *game, bool paused, const char *status);
+void handleKey(int key, Snake *snake, bool *gameOver, bool *gamePaused,
+               LatencyLog *latency);
+void endGame(int score, bool won);
+void usage(const char *program);
 
 /* Main function - entry point of the program */
-int main() {
-    /* Seed the random number generator */
-    srand(time(NULL));
-    
+int main(int argc, char *argv[]) {
     /* Game variables */
-    Snake snake;
-    Point food;
+    Game game;
+    Arena arena;
     bool gameOver = false;
     bool gamePaused = false;
-    
+    BotOptions botOptions = { NULL, NULL, AI_BUDGET_MS, NULL, 10000, NULL, 1, NULL };
+    const BotType *bot = NULL;
+    void *botState = NULL;
+    const char *shmName = SHM_BOT_DEFAULT_NAME;
+    ShmBot shmBot;
+    TickProfiler profiler;
+    bool useProfiler = false;
+    static LatencyLog latency;
+    bool useLatency = false;
+    InputReader input;
+    int tickTimer;
+    uint64_t tick = 0;
+    bool useShm = false;
+    char status[128] = "";
+    const char *player = "human";
+    const char *statsFile = NULL;
+    uint64_t seed = (uint64_t)time(NULL);
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ai") == 0 && i + 1 < argc) {
+            i++;
+            player = argv[i];
+            /* Any registered bot plays in-process; shm is a transport with
+             * a lifecycle of its own */
+            if (strcmp(argv[i], "shm") == 0) {
+                useShm = true;
+            } else if ((bot = findBot(argv[i])) == NULL) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--weights") == 0 && i + 1 < argc) {
+            botOptions.weightsFile = argv[++i];
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            botOptions.policyFile = argv[++i];
+        } else if (strcmp(argv[i], "--plugin") == 0 && i + 1 < argc) {
+            botOptions.pluginFile = argv[++i];
+        } else if (strcmp(argv[i], "--plugin-args") == 0 && i + 1 < argc) {
+            botOptions.pluginArgs = argv[++i];
+        } else if (strcmp(argv[i], "--solved") == 0 && i + 1 < argc) {
+            botOptions.solvedFile = argv[++i];
+        } else if (strcmp(argv[i], "--shm") == 0 && i + 1 < argc) {
+            shmName = argv[++i];
+        } else if (strcmp(argv[i], "--budget-us") == 0 && i + 1 < argc) {
+            botOptions.pluginBudgetUs = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            botOptions.mctsThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            statsFile = argv[++i];
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            useProfiler = true;
+        } else if (strcmp(argv[i], "--latency") == 0) {
+            useLatency = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    /* Reserve all memory the game will ever need up front */
+    if (!arenaInit(&arena, GAME_ARENA_BYTES)) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    /* Load the data the bots need (weights, networks, plugins) */
+    char error[256];
+    if (!configureBots(&botOptions, error, sizeof(error))) {
+        fprintf(stderr, "%s\n", error);
+        return 1;
+    }
+    if (bot != NULL && !botAvailable(bot)) {
+        fprintf(stderr, "The %s bot cannot play: %s\n", bot->name, bot->description);
+        return 1;
+    }
+
+    /* Share the game with a bot in another process */
+    if (useShm) {
+        char error[256];
+        if (!openShmBot(&shmBot, shmName, botOptions.pluginBudgetUs * 1000, error,
+                        sizeof(error))) {
+            fprintf(stderr, "Could not create the bot region: %s\n", error);
+            return 1;
+        }
+        printf("Waiting for a bot process on %s ...\n", shmName);
+        fflush(stdout);
+        if (!waitForShmClient(&shmBot, 60000)) {
+            fprintf(stderr, "No bot attached to %s\n", shmName);
+            closeShmBot(&shmBot);
+            return 1;
+        }
+    }
+
+    /* Start the bot (and any threads it uses) before touching the terminal */
+    if (bot != NULL && bot->create != NULL) {
+        botState = bot->create(seed);
+        if (botState == NULL) {
+            fprintf(stderr, "Could not start the %s bot\n", bot->name);
+            return 1;
+        }
+    }
+
+    /* Open the performance counters */
+    if (useProfiler) {
+        openTickProfiler(&profiler);
+    }
+
     /* Initialize ncurses library for terminal control */
     initscr();            // Initialize screen
     cbreak();             // Disable line buffering
     noecho();             // Don't echo input characters
     keypad(stdscr, TRUE); // Enable function keys (like arrow keys)
     curs_set(0);          // Hide cursor
-    timeout(100);         // Set non-blocking input with 100ms timeout
     
     /* Initialize color if terminal supports it */
     if (has_colors()) {
@@ -103,68 +201,170 @@ int main() {
         init_pair(COLOR_PAIR_TEXT, COLOR_WHITE, COLOR_BLACK);
     }
     
-    /* Initialize the game state */
-    initializeGame(&snake, &food);
+    /* Initialize the game state, seeding the random generator from the clock */
+    initializeGame(&game, &arena, seed);
+    game.stats.measureArea = statsFile != NULL;
+    if (useProfiler) {
+        game.profiler = &profiler;
+    }
+
+    /* Keys are read straight from the terminal and ticks come from a timer,
+     * both waited on by one poll() (see input.h) */
+    tickTimer = openTickTimer(TICK_MS);
+    if (tickTimer < 0 || !openInput(&input, STDIN_FILENO)) {
+        endwin();
+        fprintf(stderr, "Could not set up the terminal input and tick timer\n");
+        return 1;
+    }
     
     /* Main game loop */
+    bool redraw = true;
     while (!gameOver) {
-        /* Draw the current game state */
-        drawGame(snake, food, gamePaused);
-        
-        /* Handle user input */
-        handleInput(&snake, &gameOver, &gamePaused);
-        
-        /* Skip updates if game is paused */
-        if (gamePaused) {
-            napms(100); // Sleep to reduce CPU usage while paused
+        /* Draw the current game state; in latency mode the status shows the
+         * heading, so a frame that reflects a key can be told from outside */
+        if (redraw) {
+            if (useLatency) {
+                static const char *headings[] = { "UP", "RIGHT", "DOWN", "LEFT" };
+                snprintf(status, sizeof(status), "   |   Heading: %s",
+                         headings[game.snake.direction]);
+            }
+            if (useProfiler) {
+                profileBegin(&profiler, PHASE_RENDER);
+            }
+            drawGame(&game, gamePaused, status);
+            if (useProfiler) {
+                profileEnd(&profiler);
+            }
+            if (useLatency) {
+                latencyFlushed(&latency);
+            }
+            redraw = false;
+        }
+
+        /* Sleep until a key arrives or the next tick is due */
+        struct pollfd waiting[2] = {
+            { .fd = input.fd, .events = POLLIN },
+            { .fd = tickTimer, .events = POLLIN },
+        };
+        if (poll(waiting, 2, -1) < 0) {
             continue;
         }
         
-        /* Move the snake if the game is still active */
-        if (!gameOver) {
-            moveSnake(&snake);
-            
-            /* Check if the snake ate food */
-            if (eatFood(&snake, &food)) {
-                /* If food was eaten, place new food */
-                placeFood(snake, &food);
+        /* Handle user input the moment it arrives */
+        if (waiting[0].revents != 0) {
+            int keys[MAX_KEYS_PER_READ];
+            int count = readInput(&input, keys, MAX_KEYS_PER_READ);
+            bool wasPaused = gamePaused;
+            if (count < 0) {
+                gameOver = true;  // The terminal has gone away
             }
-            
-            /* Check for collisions with self */
-            if (checkCollision(snake)) {
-                gameOver = true;
+            for (int k = 0; k < count; k++) {
+                handleKey(keys[k], &game.snake, &gameOver, &gamePaused,
+                          useLatency ? &latency : NULL);
             }
+            redraw = redraw || gamePaused != wasPaused;
+        }
+
+        /* Move the snake once for every tick that has passed; the timer keeps
+         * counting while the game is paused, but the snake does not move */
+        uint64_t ticksDue = waiting[1].revents != 0 ? readTickTimer(tickTimer) : 0;
+        for (uint64_t t = 0; t < ticksDue && !gamePaused && !gameOver; t++) {
+            /* Let the bot steer if there is one */
+            if (bot != NULL) {
+                turnSnake(&game.snake, bot->chooseMove(botState, &game));
+                if (bot->status != NULL) {
+                    char text[96];
+                    bot->status(botState, text, sizeof(text));
+                    snprintf(status, sizeof(status), "   |   %s", text);
+                }
+            } else if (useShm) {
+                turnSnake(&game.snake, shmBotChooseMove(&shmBot, &game, tick));
+            }
+
+            /* Move, eat and check for collisions with self */
+            stepGame(&game);
+            gameOver = game.gameOver;
+            tick++;
+            if (useLatency) {
+                latencyApplied(&latency);
+            }
+            redraw = true;
         }
     }
     
     /* End game and clean up */
-    endGame(snake.size - INITIAL_SIZE);
+    closeInput(&input);
+    close(tickTimer);
+    endGame(game.snake.size - INITIAL_SIZE, game.won);
+    if (statsFile != NULL) {
+        FILE *out = fopen(statsFile, "a");
+        if (out != NULL) {
+            writeGameStats(out, &game, TICK_MS / 1000.0, player, seed);
+            fclose(out);
+        } else {
+            fprintf(stderr, "Could not write %s\n", statsFile);
+        }
+    }
+    if (bot != NULL) {
+        if (bot->status != NULL) {
+            char text[96];
+            bot->status(botState, text, sizeof(text));
+            printf("%s\n", text);
+        }
+        if (bot->destroy != NULL) {
+            bot->destroy(botState);
+        }
+    }
+    if (useShm) {
+        printShmBotStats(&shmBot);
+        closeShmBot(&shmBot);
+    }
+    if (useLatency) {
+        printLatency("Key to screen", latency.samples, latency.count, stdout);
+        if (latency.dropped > 0) {
+            printf("  (%ld more samples not kept)\n", latency.dropped);
+        }
+    }
+    if (useProfiler) {
+        printTickProfile(&profiler, stdout);
+        closeTickProfiler(&profiler);
+    }
+    arenaFree(&arena);
     
     return 0;
 }
 
-/* Initialize the game state */
-void initializeGame(Snake *snake, Point *food) {
-    /* Set initial snake position in the middle of the board */
-    int startX = WIDTH / 2;
-    int startY = HEIGHT / 2;
-    
-    /* Set initial snake properties */
-    snake->size = INITIAL_SIZE;
-    snake->direction = RIGHT;
-    
-    /* Create initial snake body segments */
-    for (int i = 0; i < snake->size; i++) {
-        snake->body[i].x = startX - i;
-        snake->body[i].y = startY;
+/* Print command line help */
+void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [--ai NAME] [--threads N]\n"
+                    "          [--weights FILE] [--policy FILE] [--solved FILE]\n"
+                    "          [--plugin FILE.so] [--plugin-args STR] [--budget-us N]\n"
+                    "          [--shm NAME] [--stats FILE] [--profile] [--latency]\n",
+            program);
+    fprintf(stderr, "  --ai NAME        Let a bot play instead:\n");
+    for (int i = 0; i < botCount(); i++) {
+        fprintf(stderr, "                     %-10s %s\n", botAt(i)->name, botAt(i)->description);
     }
-    
-    /* Place the first food item */
-    placeFood(*snake, food);
+    fprintf(stderr, "                     %-10s %s\n", "shm", "Bot in another process");
+    fprintf(stderr, "  --threads N      Number of MCTS search threads (default 1)\n");
+    fprintf(stderr, "  --weights FILE   Heuristic weights (a snake-train checkpoint)\n");
+    fprintf(stderr, "  --policy FILE    Network weights (see snake-policy --init)\n");
+    fprintf(stderr, "  --solved FILE    Policy table from snake-solve (play it with snake-tiny)\n");
+    fprintf(stderr, "  --plugin FILE    Bot plugin shared library (see snake_bot.h)\n");
+    fprintf(stderr, "  --plugin-args S  String passed to the plugin's create()\n");
+    fprintf(stderr, "  --shm NAME       Shared memory name for --ai shm (default %s)\n",
+            SHM_BOT_DEFAULT_NAME);
+    fprintf(stderr, "  --budget-us N    Bot time per move in microseconds (default 10000)\n");
+    fprintf(stderr, "  --stats FILE     Append the game's statistics to FILE as a JSON line\n");
+    fprintf(stderr, "  --latency        Print the keypress-to-screen latency at the end\n");
+    fprintf(stderr, "  --profile        Print time and CPU counters per tick phase at the end\n");
 }
 
 /* Draw the current game state on the screen */
-void drawGame(Snake snake, Point food, bool paused) {
+void drawGame(const Game *game, bool paused, const char *status) {
+    const Snake *snake = &game->snake;
+    Point food = game->food;
+
     /* Clear the screen before redrawing */
     clear();
     
@@ -183,9 +383,10 @@ void drawGame(Snake snake, Point food, bool paused) {
     }
     
     /* Place the snake on the board */
-    for (int i = 0; i < snake.size; i++) {
-        int x = snake.body[i].x;
-        int y = snake.body[i].y;
+    for (int i = 0; i < snake->size; i++) {
+        Point segment = snakeSegment(snake, i);
+        int x = segment.x;
+        int y = segment.y;
         
         /* Ensure positions are within bounds */
         if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT) {
@@ -244,7 +445,8 @@ void drawGame(Snake snake, Point food, bool paused) {
     }
     
     /* Display score information */
-    mvprintw(HEIGHT + 1, 0, "Score: %d   |   P: Pause   |   Q: Quit", snake.size - INITIAL_SIZE);
+    mvprintw(HEIGHT + 1, 0, "Score: %d   |   P: Pause   |   Q: Quit%s",
+             snake->size - INITIAL_SIZE, status);
     
     /* Display pause message if game is paused */
     if (paused) {
@@ -261,181 +463,63 @@ void drawGame(Snake snake, Point food, bool paused) {
     refresh();
 }
 
-/* Move the snake one step in its current direction */
-void moveSnake(Snake *snake) {
-    /* Get the current head position */
-    int headX = snake->body[0].x;
-    int headY = snake->body[0].y;
-    
-    /* Calculate new head position based on direction */
-    switch (snake->direction) {
-        case UP:
-            headY--;
+/* Handle one key from the terminal. Several keys can arrive between two
+ * ticks; turnSnake() checks a turn against the heading of the last move, not
+ * the direction already chosen for the next one, so two quick turns cannot
+ * send the snake back into its own neck. A latency log, if given, gets the
+ * read time of every key that changes the direction. */
+void handleKey(int key, Snake *snake, bool *gameOver, bool *gamePaused,
+               LatencyLog *latency) {
+    int direction = snake->direction;
+    int turn = -1;
+
+    switch (key) {
+        case 'p': 
+        case 'P':
+            /* Toggle pause state */
+            *gamePaused = !(*gamePaused);
             break;
-        case RIGHT:
-            headX++;
+        
+        case 'w': 
+        case INPUT_KEY_UP:
+            turn = UP;
             break;
-        case DOWN:
-            headY++;
+        case 'd': 
+        case INPUT_KEY_RIGHT:
+            turn = RIGHT;
             break;
-        case LEFT:
-            headX--;
+        case 's': 
+        case INPUT_KEY_DOWN:
+            turn = DOWN;
+            break;
+        case 'a': 
+        case INPUT_KEY_LEFT:
+            turn = LEFT;
+            break;
+        case 'q': 
+        case 'Q':
+            *gameOver = true;
             break;
     }
-    
-    /* Implement tunneling/wrap-around behavior when snake hits walls */
-    /* If snake goes off the left edge, appear on the right edge */
-    if (headX <= 0) {
-        headX = WIDTH - 2; // -2 to account for the border
-    }
-    /* If snake goes off the right edge, appear on the left edge */
-    else if (headX >= WIDTH - 1) {
-        headX = 1; // 1 to account for the border
-    }
-    /* If snake goes off the top edge, appear on the bottom edge */
-    if (headY <= 0) {
-        headY = HEIGHT - 2; // -2 to account for the border
-    }
-    /* If snake goes off the bottom edge, appear on the top edge */
-    else if (headY >= HEIGHT - 1) {
-        headY = 1; // 1 to account for the border
-    }
-    
-    /* Shift all body segments forward */
-    for (int i = snake->size - 1; i > 0; i--) {
-        snake->body[i] = snake->body[i - 1];
-    }
-    
-    /* Update head position */
-    snake->body[0].x = headX;
-    snake->body[0].y = headY;
-}
-
-/* Check if the snake has collided with itself */
-bool checkCollision(Snake snake) {
-    /* Get head position */
-    int x = snake.body[0].x;
-    int y = snake.body[0].y;
-    
-    /* No longer check for wall collisions since snake now tunnels through walls */
-    /* Wall collision code removed:
-    if (x <= 0 || x >= WIDTH - 1 || y <= 0 || y >= HEIGHT - 1) {
-        return true;
-    }
-    */
-    
-    /* Only check for collision with own body */
-    for (int i = 1; i < snake.size; i++) {
-        if (x == snake.body[i].x && y == snake.body[i].y) {
-            return true;
-        }
-    }
-    
-    return false;
-}
-
-/* Place food at a random empty position on the game board */
-void placeFood(Snake snake, Point *food) {
-    /* Create arrays to track all empty positions */
-    int emptyX[WIDTH * HEIGHT];
-    int emptyY[WIDTH * HEIGHT];
-    int emptyCount = 0;
-    
-    /* Find all empty cells on the board */
-    for (int y = 1; y < HEIGHT - 1; y++) {
-        for (int x = 1; x < WIDTH - 1; x++) {
-            bool isEmpty = true;
-            
-            /* Check if this cell contains a snake segment */
-            for (int i = 0; i < snake.size; i++) {
-                if (snake.body[i].x == x && snake.body[i].y == y) {
-                    isEmpty = false;
-                    break;
-                }
-            }
-            
-            if (isEmpty) {
-                emptyX[emptyCount] = x;
-                emptyY[emptyCount] = y;
-                emptyCount++;
-            }
-        }
-    }
-    
-    /* If there are empty cells, randomly choose one for the food */
-    if (emptyCount > 0) {
-        int randomIndex = rand() % emptyCount;
-        food->x = emptyX[randomIndex];
-        food->y = emptyY[randomIndex];
-    }
-}
 
-/* Check if the snake has eaten the food */
-bool eatFood(Snake *snake, Point *food) {
-    /* Get head position */
-    int headX = snake->body[0].x;
-    int headY = snake->body[0].y;
-    
-    /* Check if head is at the food position */
-    if (headX == food->x && headY == food->y) {
-        /* Increase snake size by duplicating the last segment */
-        snake->body[snake->size] = snake->body[snake->size - 1];
-        snake->size++;
-        return true;
+    /* Only process movement keys when game is not paused */
+    if (turn >= 0 && !(*gamePaused)) {
+        turnSnake(snake, turn);
     }
-    
-    return false;
-}
 
-/* Handle user keyboard input */
-void handleInput(Snake *snake, bool *gameOver, bool *gamePaused) {
-    int key = getch();
-    
-    if (key != ERR) {  /* ERR is returned if no key is pressed */
-        switch (key) {
-            case 'p': 
-            case 'P':
-                /* Toggle pause state */
-                *gamePaused = !(*gamePaused);
-                break;
-            
-            /* Only process movement keys when game is not paused */
-            case 'w': 
-            case KEY_UP:
-                if (!(*gamePaused) && snake->direction != DOWN)
-                    snake->direction = UP;
-                break;
-            case 'd': 
-            case KEY_RIGHT:
-                if (!(*gamePaused) && snake->direction != LEFT)
-                    snake->direction = RIGHT;
-                break;
-            case 's': 
-            case KEY_DOWN:
-                if (!(*gamePaused) && snake->direction != UP)
-                    snake->direction = DOWN;
-                break;
-            case 'a': 
-            case KEY_LEFT:
-                if (!(*gamePaused) && snake->direction != RIGHT)
-                    snake->direction = LEFT;
-                break;
-            case 'q': 
-            case 'Q':
-                *gameOver = true;
-                break;
-        }
+    if (latency != NULL && snake->direction != direction) {
+        latencyKey(latency);
     }
 }
 
 /* End the game and display the final score */
-void endGame(int score) {
+void endGame(int score, bool won) {
     /* Turn off ncurses attributes */
     curs_set(1);
     endwin();
     
     /* Print final score */
-    printf("\nGame Over!\n");
+    printf(won ? "\nYou filled the board - you win!\n" : "\nGame Over!\n");
     printf("Your final score: %d\n", score);
     printf("Thanks for playing!\n");
 } 
\ No newline at end of file
@@ -0,0 +1,77 @@
+/**
+ * Snake Game - Bot Plugin ABI
+ *
+ * This is the only header a bot plugin needs. A plugin is a shared library
+ * (.so) that exports one function:
+ *
+ *     const SnakeBotPlugin *snake_bot_entry(void);
+ *
+ * The game calls move() once per tick with a read-only view of the live
+ * game. The view points straight at the game's own arrays, so nothing is
+ * copied; the pointers are only valid during the call.
+ *
+ * Rules for keeping the ABI stable: fields are only ever added at the end of
+ * these structs, and SNAKE_BOT_ABI_VERSION goes up when that happens. The
+ * game refuses plugins built for a newer version than it knows.
+ */
+
+#ifndef SNAKE_BOT_H
+#define SNAKE_BOT_H
+
+#include <stdint.h>
+
+#define SNAKE_BOT_ABI_VERSION 1
+
+/* Directions, the same numbers the game uses */
+#define SNAKE_BOT_UP    0
+#define SNAKE_BOT_RIGHT 1
+#define SNAKE_BOT_DOWN  2
+#define SNAKE_BOT_LEFT  3
+
+/* A board cell; x runs 0 .. width - 1, y runs 0 .. height - 1, and the
+ * outermost ring of cells is the wall the snake tunnels through */
+typedef struct {
+    int32_t x;
+    int32_t y;
+} SnakeBotPoint;
+
+/* Read-only view of the game, valid only during the move() call */
+typedef struct {
+    uint32_t abiVersion;           // SNAKE_BOT_ABI_VERSION of the game
+    int32_t width;                 // Board size including the wall
+    int32_t height;
+    int32_t size;                  // Snake length
+    int32_t direction;             // Current heading (SNAKE_BOT_*)
+    int32_t ringHead;              // Ring index of the head segment
+    int32_t ringMask;              // Ring size - 1 (ring size is a power of 2)
+    const SnakeBotPoint *ring;     // Body ring, see snake_bot_segment()
+    const uint64_t *occupied;      // One bit per cell (y * width + x) under the body
+    SnakeBotPoint food;            // Food position
+    uint64_t tick;                 // Ticks played so far
+    int64_t budgetNs;              // Time allowed for this call
+} SnakeBotView;
+
+/* What a plugin provides */
+typedef struct {
+    uint32_t abiVersion;           // SNAKE_BOT_ABI_VERSION the plugin was built for
+    const char *name;              // Short name for reports
+    void *(*create)(const char *args);              // Optional, may return NULL
+    int (*move)(void *state, const SnakeBotView *view);  // Required
+    void (*destroy)(void *state);                   // Optional
+} SnakeBotPlugin;
+
+/* Segment i of the snake, counting from the head */
+static inline SnakeBotPoint snake_bot_segment(const SnakeBotView *view, int i) {
+    return view->ring[(view->ringHead + i) & view->ringMask];
+}
+
+/* True if the body covers a cell */
+static inline int snake_bot_occupied(const SnakeBotView *view, SnakeBotPoint p) {
+    int cell = p.y * view->width + p.x;
+    return (int)((view->occupied[cell >> 6] >> (cell & 63)) & 1);
+}
+
+/* Name of the function every plugin exports */
+#define SNAKE_BOT_ENTRY "snake_bot_entry"
+
+#endif /* SNAKE_BOT_H */
@@ -0,0 +1,47 @@
+/**
+ * Snake Game - Game Server Protocol
+ *
+ * snake-server hosts real-time games for clients on the network; see
+ * server.c. The protocol is plain text lines over TCP (try it with nc), and
+ * one connection can run any number of games at once.
+ *
+ * Client to server:
+ *   new [TICK_MS]                  Start a game that ticks every TICK_MS
+ *                                  milliseconds (default 100)
+ *   turn ID DIR                    Turn game ID on its next tick; DIR is
+ *                                  u, r, d or l
+ *   end ID                         Stop game ID
+ *
+ * Server to client:
+ *   game ID SEED                   The game asked for with "new" has started,
+ *                                  from the given seed
+ *   tick ID N SCORE HX HY FX FY [HASH]
+ *                                  Game ID has made its N-th move: the
+ *                                  score, then the head and food cells.
+ *                                  Every SNAKE_NET_HASH_EVERY-th tick also
+ *                                  carries the state hash (gameHash(), 16
+ *                                  hex digits)
+ *   over ID SCORE WON              Game ID has ended (WON is 1 if the snake
+ *                                  filled the board); the ID is free again
+ *   error TEXT                     A line could not be understood
+ *
+ * The game's own rules apply: a turn back into the snake's neck is ignored,
+ * and only the last turn before a tick counts.
+ *
+ * A client can run its own copy of a game: start it from SEED, and on each
+ * tick turn it the way the head moved and step it. The food then lands in
+ * the same cells, and the hashes show at once if the copies ever drift
+ * apart (snake-load --verify does this).
+ */
+
+#ifndef SNAKE_NET_H
+#define SNAKE_NET_H
+
+#define SNAKE_NET_DEFAULT_PORT 7777
+#define SNAKE_NET_MAX_LINE     128    // Longest line either side sends
+#define SNAKE_NET_DEFAULT_TICK 100    // Tick length of "new" without a number
+#define SNAKE_NET_MIN_TICK     10     // Tick lengths are clamped to this range
+#define SNAKE_NET_MAX_TICK     10000
+#define SNAKE_NET_HASH_EVERY   16     // Ticks between hashes in tick lines
+
+#endif /* SNAKE_NET_H */
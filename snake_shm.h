@@ -0,0 +1,152 @@
+/**
+ * Snake Game - Shared-Memory Bot Interface
+ *
+ * This header describes the shared-memory region the game publishes with
+ * --ai shm, for bots that run in their own process (and in any language that
+ * can map a file and make a futex call). It depends only on snake_bot.h and
+ * the Linux system headers; define _GNU_SOURCE before including it.
+ *
+ * The region (a POSIX shared memory object, /dev/shm/<name>) holds:
+ *
+ *  - A fixed header with the board size and the offsets of the two arrays.
+ *  - The game state, guarded by a seqlock: the game makes `sequence` odd
+ *    while it writes and even again when it is done. A reader copies the
+ *    state and retries if the sequence was odd or changed meanwhile, so
+ *    readers never block the game and never see a torn state.
+ *  - A turn handshake on two futex words. The game bumps `turn` and wakes
+ *    the client; the client reads the state, writes `move`, then copies the
+ *    turn number into `reply` and wakes the game. The game waits for the
+ *    reply up to the move budget; a late reply is simply ignored.
+ *
+ * The body is kept as a ring, like in the game itself: segment i is
+ * ring[(ringHead + i) & ringMask]. snake_shm_read() unrolls it head first.
+ *
+ * Layout stability follows snake_bot.h: fields are only added at the end of
+ * the header, and SNAKE_SHM_VERSION goes up when that happens.
+ */
+
+#ifndef SNAKE_SHM_H
+#define SNAKE_SHM_H
+
+#include <linux/futex.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include "snake_bot.h"
+
+#define SNAKE_SHM_MAGIC   0x4d48534bu   // "KSHM"
+#define SNAKE_SHM_VERSION 1
+#define SNAKE_SHM_DEFAULT_NAME "/snake-bot"
+
+/* Start of the shared region. The handshake words each get a cache line of
+ * their own, so the two processes do not slow each other down by writing
+ * next to what the other one is polling. */
+typedef struct SnakeShmHeader {
+    /* Fixed after the game creates the region */
+    uint32_t magic;                // SNAKE_SHM_MAGIC
+    uint32_t version;              // SNAKE_SHM_VERSION
+    int32_t width;                 // Board size including the wall
+    int32_t height;
+    uint32_t ringOffset;           // Byte offset of the body ring
+    uint32_t ringCapacity;         // Ring entries (a power of 2)
+    uint32_t gridOffset;           // Byte offset of the occupancy grid
+    uint32_t gridWords;            // 64-bit words in the grid
+    uint32_t regionSize;           // Total bytes
+    uint32_t gamePid;
+    uint8_t pad0[24];
+
+    /* Written by the game */
+    uint32_t turn;                 // Futex: bumped once per move request
+    uint32_t closed;               // 1 once the game has ended
+    uint8_t pad1[56];
+
+    /* Written by the client */
+    uint32_t reply;                // Futex: the turn the client answered
+    int32_t move;                  // The answer (SNAKE_BOT_*)
+    uint32_t clientPid;            // Futex: non-zero once a client attached
+    uint8_t pad2[52];
+
+    /* Game state, guarded by the seqlock */
+    uint32_t sequence;             // Odd while the game is writing
+    int32_t size;                  // Snake length
+    int32_t direction;             // Current heading
+    int32_t ringHead;              // Ring index of the head segment
+    SnakeBotPoint food;
+    uint64_t tick;                 // Ticks played so far
+    int64_t budgetNs;              // Time allowed for this move
+    int32_t gameOver;
+    int32_t score;
+} SnakeShmHeader;
+
+/* A consistent copy of the game state */
+typedef struct {
+    int32_t size;
+    int32_t direction;
+    SnakeBotPoint food;
+    uint64_t tick;
+    int64_t budgetNs;
+    int32_t gameOver;
+    int32_t score;
+} SnakeShmState;
+
+/* The arrays behind the header */
+static inline SnakeBotPoint *snake_shm_ring(SnakeShmHeader *shm) {
+    return (SnakeBotPoint *)((char *)shm + shm->ringOffset);
+}
+
+static inline uint64_t *snake_shm_grid(SnakeShmHeader *shm) {
+    return (uint64_t *)((char *)shm + shm->gridOffset);
+}
+
+/* Thin wrappers around the futex system call (shared, not private, since
+ * the words live in memory mapped by two processes) */
+static inline long snake_shm_wait(uint32_t *word, uint32_t expected,
+                                  const struct timespec *timeout) {
+    return syscall(SYS_futex, word, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+static inline long snake_shm_wake(uint32_t *word) {
+    return syscall(SYS_futex, word, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+/* Copy the state out under the seqlock. body gets the segments head first
+ * and must hold ringCapacity points; grid gets gridWords words. */
+static inline void snake_shm_read(SnakeShmHeader *shm, SnakeShmState *state,
+                                  SnakeBotPoint *body, uint64_t *grid) {
+    const SnakeBotPoint *ring = snake_shm_ring(shm);
+    uint32_t mask = shm->ringCapacity - 1;
+
+    for (;;) {
+        uint32_t before = __atomic_load_n(&shm->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            continue;  // The game is in the middle of a write
+        }
+
+        state->size = shm->size;
+        state->direction = shm->direction;
+        state->food = shm->food;
+        state->tick = shm->tick;
+        state->budgetNs = shm->budgetNs;
+        state->gameOver = shm->gameOver;
+        state->score = shm->score;
+
+        int32_t head = shm->ringHead;
+        int32_t size = state->size;
+        if (size < 0 || (uint32_t)size > shm->ringCapacity) {
+            size = 0;  // Torn read; the sequence check below retries it
+        }
+        for (int32_t i = 0; i < size; i++) {
+            body[i] = ring[(head + i) & mask];
+        }
+        memcpy(grid, snake_shm_grid(shm), shm->gridWords * sizeof(uint64_t));
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&shm->sequence, __ATOMIC_RELAXED) == before) {
+            return;
+        }
+    }
+}
+
+#endif /* SNAKE_SHM_H */
@@ -0,0 +1,712 @@
+/**
+ * Snake Game - Exact Solver for Tiny Boards (snake-solve)
+ *
+ * Works out perfect play for every position the game can reach on a tiny
+ * board, and writes the moves out as a policy table (solver.h) that the
+ * "solved" bot plays from with one lookup per move. It also grades other
+ * bots against it (--check), which gives heuristic AIs a ground truth.
+ *
+ * The food appears at random, so "perfect" means perfect against the worst
+ * food: a position's value is the food the snake is sure to eat from there
+ * whatever cells the food appears on, and, among moves that are equally
+ * sure of it, the fewest ticks it needs in the worst case. A value that
+ * includes the last free cell is a guaranteed win in that many ticks.
+ *
+ * The solver runs in three steps:
+ *
+ *   1. Every body the game can reach is enumerated from the starting snake,
+ *      breadth first. Bodies are stored once each, keyed like the table
+ *      (see solver.h), with a bitboard of the cells they cover and the body
+ *      each move leads to, both without and with eating. A position is a
+ *      body and one of its free cells for the food.
+ *   2. Eating makes the snake longer, so positions are solved size by size,
+ *      longest first. Eating leads to a size that is already solved, at the
+ *      worst free cell for the new food. Within a size, moves that do not
+ *      eat can go round in circles, so the values there are improved sweep
+ *      after sweep until none changes. The sweeps are split over threads,
+ *      which read and write the values in place.
+ *   3. The best move of every position is packed into the table and saved.
+ *
+ * The board is the one the program was built for (make builds it with
+ * SOLVE_BOARD). The number of bodies grows very fast with the board: 4 x 3
+ * inside the border is solved in under a second and 4 x 4 (the default,
+ * 2.7 million bodies) in about ten, but 5 x 4 has too many bodies to even
+ * enumerate in minutes.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "game.h"
+#include "bots.h"
+#include "solver.h"
+#include "clock.h"
+
+#define SOLVE_MAX_THREADS 256
+#define SOLVE_NONE (-1)              // Reversing, which the game ignores
+#define SOLVE_DEAD (-2)              // The move bites the body
+#define SOLVE_WIN  (-3)              // Eating here fills the board
+#define SOLVE_EATS (-4)              // The food must be on the cell, so the move eats
+
+/* Bitboard of every cell inside the border */
+#define FULL_BOARD ((uint32_t)((1ULL << PLAY_CELLS) - 1))
+
+/* A value: the food sure to be eaten in the top 8 bits, and 0xFFFFFF less
+ * the ticks it takes in the rest, so a larger value is always better. No
+ * food is worth 0 whatever the ticks. */
+#define VALUE(food, ticks) ((uint32_t)(food) << 24 | (0xFFFFFFu - (uint32_t)(ticks)))
+#define VALUE_FOOD(value)  ((int)((value) >> 24))
+#define VALUE_TICKS(value) ((value) >> 24 ? (int)(0xFFFFFFu - ((value) & 0xFFFFFFu)) : 0)
+
+/* One reachable body */
+typedef struct {
+    uint64_t key;
+    uint32_t covered;                // Bitboard of the cells it covers
+    int32_t next[4];                 // Body after each move that does not eat
+    int32_t grown[4];                // Body after each move that eats
+    int8_t cell[4];                  // Cell each move enters
+    int8_t heading;
+    int8_t size;
+} SolveBody;
+
+/* Everything the solver knows */
+typedef struct {
+    SolveBody *bodies;
+    long count;
+    long capacity;
+    int32_t *index;                  // Body key hash -> body, -1 if empty
+    uint64_t indexMask;
+    uint32_t *value;                 // count * PLAY_CELLS position values
+    uint32_t *worst;                 // Value of each body at its worst food
+    long *order;                     // Bodies sorted by size
+    long sizeStart[SOLVED_MAX_CELLS + 3];
+} Solver;
+
+/* Work shared by the solving threads */
+typedef struct {
+    Solver *solver;
+    int threads;
+    pthread_barrier_t barrier;
+    int changed;                     // Some value changed in this sweep
+    bool settled;                    // The last sweep changed nothing
+    long sweeps;
+} SolveWork;
+
+typedef struct {
+    SolveWork *work;
+    int id;
+    pthread_t thread;
+} SolveThread;
+
+/* Function prototypes */
+int decodeBody(uint64_t key, int *cells);
+long findBody(Solver *solver, uint64_t key, bool add);
+bool enumerateBodies(Solver *solver, const int *start, int startSize);
+uint32_t moveValue(const Solver *solver, long body, int food, int dir);
+uint32_t evaluate(const Solver *solver, long body, int food, int *move);
+void *solveThread(void *arg);
+bool solveAll(Solver *solver, int threads);
+bool buildTable(const Solver *solver, SolvedTable *table);
+void checkBots(const Solver *solver, const char *names, long samples, uint64_t seed);
+void setPosition(Game *game, const int *cells, int size, int food, int moves);
+void startingSnake(int *cells, int *size);
+void usage(const char *program);
+
+/* Main function - entry point of the program */
+int main(int argc, char *argv[]) {
+    static Solver solver;
+    BotOptions botOptions = { NULL, NULL, 1, NULL, 10000, NULL, 1, NULL };
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char *outFile = "snake-solved.bin";
+    const char *checkNames = NULL;
+    long samples = 20000;
+    uint64_t seed = (uint64_t)time(NULL);
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outFile = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--check") == 0 && i + 1 < argc) {
+            checkNames = argv[++i];
+        } else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            samples = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--weights") == 0 && i + 1 < argc) {
+            botOptions.weightsFile = argv[++i];
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            botOptions.policyFile = argv[++i];
+        } else if (strcmp(argv[i], "--mcts-ms") == 0 && i + 1 < argc) {
+            botOptions.mctsBudgetMs = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (samples < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > SOLVE_MAX_THREADS) threads = SOLVE_MAX_THREADS;
+    if (!SOLVED_BOARD_OK) {
+        fprintf(stderr, "The solver needs a board of 4 x 3 to %d cells inside the border "
+                "(this one is %d x %d)\n", SOLVED_MAX_CELLS, SOLVED_WIDTH, SOLVED_HEIGHT);
+        return 1;
+    }
+
+    int start[INITIAL_SIZE];
+    int startSize;
+    startingSnake(start, &startSize);
+    printf("Board %d x %d inside the border, %d threads\n", SOLVED_WIDTH, SOLVED_HEIGHT,
+           threads);
+
+    /* Step 1: every reachable body */
+    double began = secondsNow();
+    if (!enumerateBodies(&solver, start, startSize)) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    long positions = 0;
+    for (long b = 0; b < solver.count; b++) {
+        positions += PLAY_CELLS - __builtin_popcount(solver.bodies[b].covered);
+    }
+    printf("%ld bodies, %ld positions (%.2f s)\n", solver.count, positions,
+           secondsNow() - began);
+
+    /* Step 2: their values */
+    began = secondsNow();
+    if (!solveAll(&solver, threads)) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    printf("Solved in %.2f s\n", secondsNow() - began);
+
+    /* What the start is worth, over the cells the first food can appear on */
+    long startBody = findBody(&solver, solvedBodyKey(start, startSize), false);
+    int foodToWin = PLAY_CELLS + 1 - startSize;
+    int minFood = foodToWin;
+    int maxFood = 0;
+    int worstTicks = 0;
+    for (int food = 0; food < PLAY_CELLS; food++) {
+        if ((solver.bodies[startBody].covered >> food) & 1) {
+            continue;
+        }
+        uint32_t value = solver.value[startBody * PLAY_CELLS + food];
+        if (VALUE_FOOD(value) < minFood) minFood = VALUE_FOOD(value);
+        if (VALUE_FOOD(value) > maxFood) maxFood = VALUE_FOOD(value);
+        if (VALUE_FOOD(value) == foodToWin && VALUE_TICKS(value) > worstTicks) {
+            worstTicks = VALUE_TICKS(value);
+        }
+    }
+    if (minFood == foodToWin) {
+        printf("From the start the board is always filled, in at most %d ticks\n", worstTicks);
+    } else {
+        printf("From the start %d to %d food is guaranteed (%d fills the board)\n",
+               minFood, maxFood, foodToWin);
+    }
+
+    /* Step 3: the table */
+    SolvedTable table;
+    if (!buildTable(&solver, &table) || !saveSolvedTable(&table, outFile)) {
+        fprintf(stderr, "Could not write %s\n", outFile);
+        return 1;
+    }
+    printf("Wrote %s (%llu slots)\n", outFile, (unsigned long long)table.mask + 1);
+    freeSolvedTable(&table);
+
+    if (checkNames != NULL) {
+        botOptions.solvedFile = outFile;  // The solved bot plays the table just written
+        char error[256];
+        if (!configureBots(&botOptions, error, sizeof(error))) {
+            fprintf(stderr, "%s\n", error);
+            return 1;
+        }
+        checkBots(&solver, checkNames, samples, seed);
+    }
+    return 0;
+}
+
+/* Cells of a body from its key; returns the size */
+int decodeBody(uint64_t key, int *cells) {
+    int size = (int)(key >> 58);
+    bool doubled = (key >> 57) & 1;
+    int covered = doubled ? size - 1 : size;
+
+    cells[0] = (int)((key >> 52) & 31);
+    for (int i = 0; i + 1 < covered; i++) {
+        int dir = (int)((key >> (2 * i)) & 3);
+        cells[i + 1] = solvedCell(movePoint(solvedPoint(cells[i]), OPPOSITE(dir)));
+    }
+    if (doubled) {
+        cells[size - 1] = cells[size - 2];
+    }
+    return size;
+}
+
+/* Body number of a key, or -1. With 'add' an unknown key becomes a new
+ * body (-1 if memory runs out). */
+long findBody(Solver *solver, uint64_t key, bool add) {
+    uint64_t slot = solvedSlotFor(key, solver->indexMask);
+
+    while (solver->index[slot] >= 0) {
+        if (solver->bodies[solver->index[slot]].key == key) {
+            return solver->index[slot];
+        }
+        slot = (slot + 1) & solver->indexMask;
+    }
+    if (!add) {
+        return -1;
+    }
+
+    /* Keep the index at most half full, and the body array big enough */
+    if ((uint64_t)(solver->count + 1) * 2 > solver->indexMask + 1) {
+        uint64_t mask = solver->indexMask * 2 + 1;
+        int32_t *index = malloc((mask + 1) * sizeof(int32_t));
+        if (index == NULL) {
+            return -1;
+        }
+        memset(index, 0xFF, (mask + 1) * sizeof(int32_t));
+        for (long b = 0; b < solver->count; b++) {
+            uint64_t s = solvedSlotFor(solver->bodies[b].key, mask);
+            while (index[s] >= 0) {
+                s = (s + 1) & mask;
+            }
+            index[s] = (int32_t)b;
+        }
+        free(solver->index);
+        solver->index = index;
+        solver->indexMask = mask;
+        slot = solvedSlotFor(key, mask);
+        while (index[slot] >= 0) {
+            slot = (slot + 1) & mask;
+        }
+    }
+    if (solver->count == solver->capacity) {
+        long capacity = solver->capacity * 2;
+        SolveBody *bodies = realloc(solver->bodies, capacity * sizeof(SolveBody));
+        if (bodies == NULL) {
+            return -1;
+        }
+        solver->bodies = bodies;
+        solver->capacity = capacity;
+    }
+
+    SolveBody *body = &solver->bodies[solver->count];
+    memset(body, 0, sizeof(*body));
+    body->key = key;
+    solver->index[slot] = (int32_t)solver->count;
+    return solver->count++;
+}
+
+/* Step 1: find every body the starting snake can turn into. The bodies are
+ * their own queue: each is expanded in the order it was found. */
+bool enumerateBodies(Solver *solver, const int *start, int startSize) {
+    int cells[SOLVED_MAX_CELLS + 2];
+    int moved[SOLVED_MAX_CELLS + 2];
+
+    solver->capacity = 1024;
+    solver->bodies = malloc(solver->capacity * sizeof(SolveBody));
+    solver->indexMask = 2047;
+    solver->index = malloc((solver->indexMask + 1) * sizeof(int32_t));
+    if (solver->bodies == NULL || solver->index == NULL) {
+        return false;
+    }
+    memset(solver->index, 0xFF, (solver->indexMask + 1) * sizeof(int32_t));
+    if (findBody(solver, solvedBodyKey(start, startSize), true) < 0) {
+        return false;
+    }
+
+    for (long b = 0; b < solver->count; b++) {
+        uint64_t key = solver->bodies[b].key;
+        int size = decodeBody(key, cells);
+        bool doubled = (key >> 57) & 1;
+        int heading = (int)(key & 3);
+        uint32_t covered = 0;
+
+        for (int i = 0; i < size; i++) {
+            covered |= 1u << cells[i];
+        }
+        /* The tail leaves its cell as the head moves, unless it just grew */
+        uint32_t blocked = doubled ? covered : covered & ~(1u << cells[size - 1]);
+
+        int32_t next[4];
+        int32_t grown[4];
+        int8_t entered[4];
+        for (int dir = 0; dir < 4; dir++) {
+            next[dir] = grown[dir] = SOLVE_NONE;
+            entered[dir] = -1;
+            if (dir == OPPOSITE(heading)) {
+                continue;
+            }
+            int head = solvedCell(movePoint(solvedPoint(cells[0]), dir));
+            entered[dir] = (int8_t)head;
+            if ((blocked >> head) & 1) {
+                next[dir] = grown[dir] = SOLVE_DEAD;
+                continue;
+            }
+
+            /* Without eating, unless the cell is the only free one */
+            moved[0] = head;
+            memcpy(&moved[1], cells, (size - 1) * sizeof(int));
+            if ((FULL_BOARD & ~covered & ~(1u << head)) == 0) {
+                next[dir] = SOLVE_EATS;
+            } else {
+                long id = findBody(solver, solvedBodyKey(moved, size), true);
+                if (id < 0) {
+                    return false;
+                }
+                next[dir] = (int32_t)id;
+            }
+
+            /* Food can only be on a cell the body does not cover */
+            if ((covered >> head) & 1) {
+                continue;
+            }
+            moved[size] = moved[size - 1];
+            if (__builtin_popcount(blocked | 1u << head) == PLAY_CELLS) {
+                grown[dir] = SOLVE_WIN;
+                continue;
+            }
+            long id = findBody(solver, solvedBodyKey(moved, size + 1), true);
+            if (id < 0) {
+                return false;
+            }
+            grown[dir] = (int32_t)id;
+        }
+
+        /* The array may have moved while bodies were added */
+        SolveBody *body = &solver->bodies[b];
+        body->covered = covered;
+        body->heading = (int8_t)heading;
+        body->size = (int8_t)size;
+        memcpy(body->next, next, sizeof(next));
+        memcpy(body->grown, grown, sizeof(grown));
+        memcpy(body->cell, entered, sizeof(entered));
+    }
+    return true;
+}
+
+/* Value of one move from a position (0 if it bites the body) */
+uint32_t moveValue(const Solver *solver, long body, int food, int dir) {
+    const SolveBody *b = &solver->bodies[body];
+    int32_t next = b->next[dir];
+
+    if (next == SOLVE_DEAD) {
+        return 0;
+    }
+    if (b->cell[dir] != food) {
+        uint32_t value = __atomic_load_n(&solver->value[(long)next * PLAY_CELLS + food],
+                                         __ATOMIC_RELAXED);
+        return value >> 24 && (value & 0xFFFFFF) > 0 ? value - 1 : value;  // A tick later
+    }
+    if (b->grown[dir] == SOLVE_WIN) {
+        return VALUE(1, 1);
+    }
+
+    /* Eating: the new food lands on the worst cell for the longer body */
+    uint32_t after = __atomic_load_n(&solver->worst[b->grown[dir]], __ATOMIC_RELAXED);
+    int ticks = VALUE_TICKS(after) + 1;
+    return VALUE(VALUE_FOOD(after) + 1, ticks < 0xFFFFFF ? ticks : 0xFFFFFF);
+}
+
+/* Best value of a position, and the move that gets it. Moves that end the
+ * game at once lose ties against moves that do not. */
+uint32_t evaluate(const Solver *solver, long body, int food, int *move) {
+    const SolveBody *b = &solver->bodies[body];
+    uint64_t best = 0;
+
+    *move = b->heading;
+    for (int dir = 0; dir < 4; dir++) {
+        if (b->next[dir] == SOLVE_NONE) {
+            continue;
+        }
+        uint64_t rank = (uint64_t)moveValue(solver, body, food, dir) << 1 |
+                        (b->next[dir] != SOLVE_DEAD);
+        if (rank > best) {
+            best = rank;
+            *move = dir;
+        }
+    }
+    return (uint32_t)(best >> 1);
+}
+
+/* Step 2, on one thread: its share of every sweep of every size */
+void *solveThread(void *arg) {
+    SolveThread *self = arg;
+    SolveWork *work = self->work;
+    Solver *solver = work->solver;
+
+    for (int size = SOLVED_MAX_CELLS + 1; size >= INITIAL_SIZE; size--) {
+        long first = solver->sizeStart[size];
+        long last = solver->sizeStart[size + 1];
+        if (first == last) {
+            continue;
+        }
+
+        /* Sweep until nothing changes; a sweep uses values written by the
+         * others in the same sweep, which only makes it settle sooner */
+        do {
+            bool changed = false;
+            for (long i = first + self->id; i < last; i += work->threads) {
+                long body = solver->order[i];
+                uint32_t free = ~solver->bodies[body].covered;
+                for (int food = 0; food < PLAY_CELLS; food++) {
+                    int move;
+                    if (!((free >> food) & 1)) {
+                        continue;
+                    }
+                    uint32_t value = evaluate(solver, body, food, &move);
+                    uint32_t *slot = &solver->value[body * PLAY_CELLS + food];
+                    if (value != __atomic_load_n(slot, __ATOMIC_RELAXED)) {
+                        __atomic_store_n(slot, value, __ATOMIC_RELAXED);
+                        changed = true;
+                    }
+                }
+            }
+            if (changed) {
+                __atomic_store_n(&work->changed, 1, __ATOMIC_RELAXED);
+            }
+            pthread_barrier_wait(&work->barrier);
+            if (self->id == 0) {
+                work->settled = !__atomic_load_n(&work->changed, __ATOMIC_RELAXED);
+                work->changed = 0;
+                work->sweeps++;
+            }
+            pthread_barrier_wait(&work->barrier);
+        } while (!work->settled);
+
+        /* What each body is worth when the food lands where it hurts most */
+        for (long i = first + self->id; i < last; i += work->threads) {
+            long body = solver->order[i];
+            uint32_t free = ~solver->bodies[body].covered;
+            uint32_t worst = UINT32_MAX;
+            for (int food = 0; food < PLAY_CELLS; food++) {
+                if ((free >> food) & 1 && solver->value[body * PLAY_CELLS + food] < worst) {
+                    worst = solver->value[body * PLAY_CELLS + food];
+                }
+            }
+            solver->worst[body] = worst;
+        }
+        pthread_barrier_wait(&work->barrier);
+    }
+    return NULL;
+}
+
+/* Step 2: solve every position, longest bodies first */
+bool solveAll(Solver *solver, int threads) {
+    static SolveWork work;
+    static SolveThread workers[SOLVE_MAX_THREADS];
+
+    solver->value = calloc((size_t)solver->count * PLAY_CELLS, sizeof(uint32_t));
+    solver->worst = calloc((size_t)solver->count, sizeof(uint32_t));
+    solver->order = malloc((size_t)solver->count * sizeof(long));
+    if (solver->value == NULL || solver->worst == NULL || solver->order == NULL) {
+        return false;
+    }
+
+    /* Group the bodies by size (counting sort) */
+    memset(solver->sizeStart, 0, sizeof(solver->sizeStart));
+    for (long b = 0; b < solver->count; b++) {
+        solver->sizeStart[solver->bodies[b].size + 1]++;
+    }
+    for (int size = 1; size <= SOLVED_MAX_CELLS + 2; size++) {
+        solver->sizeStart[size] += solver->sizeStart[size - 1];
+    }
+    long fill[SOLVED_MAX_CELLS + 3];
+    memcpy(fill, solver->sizeStart, sizeof(fill));
+    for (long b = 0; b < solver->count; b++) {
+        solver->order[fill[solver->bodies[b].size]++] = b;
+    }
+
+    work.solver = solver;
+    work.threads = threads;
+    pthread_barrier_init(&work.barrier, NULL, threads);
+    for (int t = 0; t < threads; t++) {
+        workers[t].work = &work;
+        workers[t].id = t;
+    }
+    for (int t = 1; t < threads; t++) {
+        if (pthread_create(&workers[t].thread, NULL, solveThread, &workers[t]) != 0) {
+            fprintf(stderr, "Could not start thread %d\n", t);
+            exit(1);
+        }
+    }
+    solveThread(&workers[0]);
+    for (int t = 1; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+    }
+    pthread_barrier_destroy(&work.barrier);
+    int sizes = 0;
+    for (int size = 0; size <= SOLVED_MAX_CELLS + 1; size++) {
+        sizes += solver->sizeStart[size + 1] > solver->sizeStart[size];
+    }
+    printf("%ld sweeps over %d sizes\n", work.sweeps, sizes);
+    return true;
+}
+
+/* Step 3: the best move of every position, in the on-disk layout */
+bool buildTable(const Solver *solver, SolvedTable *table) {
+    uint64_t slots = 1;
+
+    /* At most three quarters full, so probes stay short */
+    while (slots * 3 < (uint64_t)solver->count * 4) {
+        slots *= 2;
+    }
+    table->slots = calloc(slots, sizeof(SolvedSlot));
+    if (table->slots == NULL) {
+        return false;
+    }
+    table->mask = slots - 1;
+    table->bodies = solver->count;
+
+    for (long b = 0; b < solver->count; b++) {
+        const SolveBody *body = &solver->bodies[b];
+        uint64_t moves = 0;
+        for (int food = 0; food < PLAY_CELLS; food++) {
+            int move;
+            if (!((body->covered >> food) & 1)) {
+                evaluate(solver, b, food, &move);
+                moves |= (uint64_t)move << (2 * food);
+            }
+        }
+        uint64_t slot = solvedSlotFor(body->key, table->mask);
+        while (table->slots[slot].key != 0) {
+            slot = (slot + 1) & table->mask;
+        }
+        table->slots[slot].key = body->key;
+        table->slots[slot].moves = moves;
+    }
+    return true;
+}
+
+/* Grade bots on random positions: how often their move keeps the food the
+ * position guarantees, and how often it is perfect (in ticks too) */
+void checkBots(const Solver *solver, const char *names, long samples, uint64_t seed) {
+    char list[256];
+    Arena arena;
+
+    snprintf(list, sizeof(list), "%s", names);
+    if (!arenaInit(&arena, GAME_ARENA_BYTES + 64 * sizeof(Point) + ARENA_ALIGN)) {
+        fprintf(stderr, "Out of memory\n");
+        return;
+    }
+
+    printf("\nbot          positions   keeps food   perfect   dies early\n");
+    for (char *name = strtok(list, ","); name != NULL; name = strtok(NULL, ",")) {
+        const BotType *type = findBot(name);
+        if (type == NULL || !botAvailable(type)) {
+            fprintf(stderr, "Bot '%s' is not available\n", name);
+            continue;
+        }
+
+        Game game;
+        arenaReset(&arena);
+        initializeGame(&game, &arena, seed);
+        game.snake.body = arenaAlloc(&arena, 64 * sizeof(Point));
+        game.snake.capacity = 64;
+        void *state = type->create != NULL ? type->create(seed) : NULL;
+
+        uint64_t rng = seed;
+        long keeps = 0;
+        long perfect = 0;
+        long diesEarly = 0;
+        for (long s = 0; s < samples; s++) {
+            int cells[SOLVED_MAX_CELLS + 2];
+            long body = (long)gameRandomBelow(&rng, (uint32_t)solver->count);
+            const SolveBody *b = &solver->bodies[body];
+            int free = PLAY_CELLS - __builtin_popcount(b->covered);
+            int pick = (int)gameRandomBelow(&rng, (uint32_t)free);
+            int food = 0;
+            while ((b->covered >> food) & 1 || pick-- > 0) {
+                food++;
+            }
+            int size = decodeBody(b->key, cells);
+
+            /* Every position is a new game to the bot */
+            if (type->newGame != NULL) {
+                type->newGame(state);
+            }
+            setPosition(&game, cells, size, food, 1000);
+            int dir = type->chooseMove(state, &game);
+            if (dir < 0 || dir > 3 || dir == OPPOSITE(b->heading)) {
+                dir = b->heading;
+            }
+
+            /* The value of the bot's move against the best one */
+            int bestMove;
+            uint32_t best = evaluate(solver, body, food, &bestMove);
+            uint32_t got = moveValue(solver, body, food, dir);
+            if (VALUE_FOOD(got) == VALUE_FOOD(best)) keeps++;
+            if (got == best) perfect++;
+            if (b->next[dir] == SOLVE_DEAD && b->next[bestMove] != SOLVE_DEAD) {
+                diesEarly++;
+            }
+        }
+
+        if (type->destroy != NULL) {
+            type->destroy(state);
+        }
+        printf("%-12s %9ld %11.1f%% %8.1f%% %11.1f%%\n", name, samples,
+               100.0 * keeps / samples, 100.0 * perfect / samples, 100.0 * diesEarly / samples);
+    }
+    arenaFree(&arena);
+}
+
+/* Put a game into the given position */
+void setPosition(Game *game, const int *cells, int size, int food, int moves) {
+    Snake *snake = &game->snake;
+
+    memset(snake->occupied, 0, GRID_WORDS * sizeof(uint64_t));
+    snake->head = 0;
+    snake->size = size;
+    snake->moves = moves;
+    snake->bitten = false;
+    for (int i = size - 1; i >= 0; i--) {
+        Point p = solvedPoint(cells[i]);
+        int cell = cellIndex(p);
+        snake->body[i] = p;
+        snake->occupied[cell >> 6] |= 1ULL << (cell & 63);
+        snake->enteredAt[cell] = moves - i;
+    }
+    snake->direction = (int)(solvedBodyKey(cells, size) & 3);
+    snake->heading = snake->direction;
+    game->food = solvedPoint(food);
+    game->gameOver = false;
+    game->won = false;
+    snake->hash = computeSnakeHash(snake);
+}
+
+/* Cells of the snake a new game starts with */
+void startingSnake(int *cells, int *size) {
+    static Game game;
+    Arena arena;
+
+    arenaInit(&arena, GAME_ARENA_BYTES);
+    initializeGame(&game, &arena, 1);
+    *size = game.snake.size;
+    for (int i = 0; i < game.snake.size; i++) {
+        cells[i] = solvedCell(snakeSegment(&game.snake, i));
+    }
+    arenaFree(&arena);
+}
+
+/* Print command line help */
+void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --out FILE        Policy table to write (default snake-solved.bin)\n");
+    fprintf(stderr, "  --threads N       Solving threads (default: one per CPU)\n");
+    fprintf(stderr, "  --check A,B,...   Grade these bots against the solution\n");
+    fprintf(stderr, "  --samples N       Positions per bot for --check (default 20000)\n");
+    fprintf(stderr, "  --seed N          Seed for the sampled positions (default: clock)\n");
+    fprintf(stderr, "  --weights FILE    Heuristic bot weights\n");
+    fprintf(stderr, "  --policy FILE     Policy bot network\n");
+    fprintf(stderr, "  --mcts-ms N       MCTS bot thinking time per move (default 1)\n");
+}
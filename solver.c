@@ -0,0 +1,130 @@
+/**
+ * Snake Game - Solved Policy Tables
+ *
+ * See solver.h. The file is a text header line, "snake-solved-1 WIDTH
+ * HEIGHT BODIES SLOTS", followed by the slots as they sit in memory.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "solver.h"
+
+/* Direction that leads from one cell to a neighbouring one */
+static int stepDirection(int from, int to) {
+    Point p = solvedPoint(from);
+    for (int dir = 0; dir < 4; dir++) {
+        if (solvedCell(movePoint(p, dir)) == to) {
+            return dir;
+        }
+    }
+    return 0;
+}
+
+/* Key of a body given as cell numbers, head first. A freshly grown tail
+ * repeats the cell before it. */
+uint64_t solvedBodyKey(const int *cells, int size) {
+    bool doubled = size >= 2 && cells[size - 1] == cells[size - 2];
+    int covered = doubled ? size - 1 : size;
+    uint64_t key = (uint64_t)size << 58 | (uint64_t)doubled << 57 | (uint64_t)cells[0] << 52;
+
+    for (int i = 0; i + 1 < covered; i++) {
+        key |= (uint64_t)stepDirection(cells[i + 1], cells[i]) << (2 * i);
+    }
+    return key;
+}
+
+/* Key of a snake in play; false if it is too long for a key */
+bool solvedSnakeKey(const Snake *snake, uint64_t *key) {
+    int cells[SOLVED_MAX_CELLS + 1];
+
+    if (snake->size > SOLVED_MAX_CELLS + 1) {
+        return false;
+    }
+    for (int i = 0; i < snake->size; i++) {
+        cells[i] = solvedCell(snakeSegment(snake, i));
+    }
+    *key = solvedBodyKey(cells, snake->size);
+    return true;
+}
+
+/* Load a table made by snake-solve for the board this program was built
+ * for; on failure 'error' says why */
+bool loadSolvedTable(SolvedTable *table, const char *path, char *error, size_t errorSize) {
+    int width = 0;
+    int height = 0;
+    long bodies = 0;
+    long slots = 0;
+    FILE *file = fopen(path, "rb");
+
+    table->slots = NULL;
+    if (file == NULL) {
+        snprintf(error, errorSize, "%s: %s", path, strerror(errno));
+        return false;
+    }
+    if (fscanf(file, SOLVED_MAGIC " %d %d %ld %ld", &width, &height, &bodies, &slots) != 4 ||
+        fgetc(file) != '\n' || slots <= 0 || (slots & (slots - 1)) != 0 || bodies >= slots) {
+        snprintf(error, errorSize, "%s is not a table written by snake-solve", path);
+        fclose(file);
+        return false;
+    }
+    if (width != WIDTH || height != HEIGHT) {
+        snprintf(error, errorSize, "%s was solved for a %d x %d board, but this program "
+                 "plays on %d x %d (snake-tiny and snake-tourney-tiny play on the "
+                 "solver's board)", path, width, height, WIDTH, HEIGHT);
+        fclose(file);
+        return false;
+    }
+
+    table->slots = malloc((size_t)slots * sizeof(SolvedSlot));
+    if (table->slots == NULL ||
+        fread(table->slots, sizeof(SolvedSlot), (size_t)slots, file) != (size_t)slots) {
+        snprintf(error, errorSize, table->slots == NULL ? "Out of memory for %s" :
+                 "%s is shorter than its header says", path);
+        fclose(file);
+        freeSolvedTable(table);
+        return false;
+    }
+    fclose(file);
+    table->mask = (uint64_t)slots - 1;
+    table->bodies = bodies;
+    return true;
+}
+
+/* Save a table in the format loadSolvedTable() reads */
+bool saveSolvedTable(const SolvedTable *table, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, SOLVED_MAGIC " %d %d %ld %llu\n", WIDTH, HEIGHT, table->bodies,
+            (unsigned long long)table->mask + 1);
+    size_t written = fwrite(table->slots, sizeof(SolvedSlot), table->mask + 1, file);
+    return (fclose(file) == 0) & (written == table->mask + 1);
+}
+
+void freeSolvedTable(SolvedTable *table) {
+    free(table->slots);
+    table->slots = NULL;
+}
+
+/* The table's move for the game; keep going if the position is not in it */
+int solvedChooseMove(const SolvedTable *table, const Game *game) {
+    const Snake *snake = &game->snake;
+    uint64_t key;
+
+    if (!solvedSnakeKey(snake, &key)) {
+        return snake->direction;
+    }
+    for (uint64_t slot = solvedSlotFor(key, table->mask);; slot = (slot + 1) & table->mask) {
+        const SolvedSlot *entry = &table->slots[slot];
+        if (entry->key == key) {
+            return (int)((entry->moves >> (2 * solvedCell(game->food))) & 3);
+        }
+        if (entry->key == 0) {
+            return snake->direction;
+        }
+    }
+}
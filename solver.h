@@ -0,0 +1,75 @@
+/**
+ * Snake Game - Solved Policy Tables
+ *
+ * On tiny boards every position the game can reach can be enumerated, and
+ * snake-solve works out the best move for each of them (see solve.c). The
+ * result is stored on disk as a policy table, which this module loads and
+ * looks moves up in, in O(1), during play.
+ *
+ * A position is the body and the food. The body is keyed in one 64-bit
+ * word: its size, whether the tail has just grown (the last two segments
+ * share a cell), the head's cell, and the direction from each segment to
+ * the next, two bits each. The heading is the direction from the neck to
+ * the head, so the key holds all of the snake. The table has one slot per
+ * body, with the move for every food cell packed two bits each, and is
+ * hashed by body key with linear probing.
+ *
+ * The key has room for SOLVED_MAX_CELLS cells inside the border. Boards
+ * must also be at least 4 x 3 inside, so the starting snake fits and no
+ * two directions lead to the same cell.
+ */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+
+#define SOLVED_MAX_CELLS 25          // Most cells inside the border
+#define SOLVED_MAGIC "snake-solved-1"
+
+/* Board inside the border */
+#define SOLVED_WIDTH  (WIDTH - 2)
+#define SOLVED_HEIGHT (HEIGHT - 2)
+#define SOLVED_BOARD_OK \
+    (SOLVED_WIDTH >= 4 && SOLVED_HEIGHT >= 3 && PLAY_CELLS <= SOLVED_MAX_CELLS)
+
+/* One body and its moves */
+typedef struct {
+    uint64_t key;                    // Body key (0 for an empty slot)
+    uint64_t moves;                  // Direction to take for food on cell c at bits 2c
+} SolvedSlot;
+
+/* A loaded table */
+typedef struct {
+    SolvedSlot *slots;
+    uint64_t mask;                   // Slot count - 1 (a power of two)
+    long bodies;
+} SolvedTable;
+
+/* Cell number inside the border (0 to PLAY_CELLS - 1) of a board point */
+static inline int solvedCell(Point p) {
+    return (p.y - 1) * SOLVED_WIDTH + (p.x - 1);
+}
+
+/* Board point of a cell number */
+static inline Point solvedPoint(int cell) {
+    Point p = { 1 + cell % SOLVED_WIDTH, 1 + cell / SOLVED_WIDTH };
+    return p;
+}
+
+/* Slot a body key starts probing from */
+static inline uint64_t solvedSlotFor(uint64_t key, uint64_t mask) {
+    return (key * 0x9E3779B97F4A7C15ULL >> 32) & mask;
+}
+
+/* Function prototypes */
+uint64_t solvedBodyKey(const int *cells, int size);
+bool solvedSnakeKey(const Snake *snake, uint64_t *key);
+bool loadSolvedTable(SolvedTable *table, const char *path, char *error, size_t errorSize);
+bool saveSolvedTable(const SolvedTable *table, const char *path);
+void freeSolvedTable(SolvedTable *table);
+int solvedChooseMove(const SolvedTable *table, const Game *game);
+
+#endif /* SOLVER_H */
@@ -0,0 +1,320 @@
+/**
+ * Snake Game - Timer Benchmark (snake-timerbench)
+ *
+ * Compares the two ways snake-server can schedule game ticks, on one
+ * thread and without any networking, so only the timers are measured:
+ *
+ *   fd     every timer is a periodic timerfd in one epoll set, and every
+ *          expiration is an epoll event and a read()
+ *   wheel  every timer sits in a hashed timer wheel (timerwheel.h) and the
+ *          thread has one timerfd, armed for the next slot that is due
+ *
+ * Each timer gets a random period between --min-ms and --max-ms and fires
+ * for --seconds. Reported for each mode: the time to set the timers up,
+ * the CPU time spent per expiration, how often the thread woke up, and how
+ * late the timers fired.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/timerfd.h>
+#include "game.h"
+#include "timerwheel.h"
+#include "clock.h"
+
+#define LATE_BUCKETS 1000            // 0.01 ms each, so up to 10 ms
+#define BATCH_EVENTS 1024
+
+/* One benchmark timer */
+typedef struct {
+    int fd;                          // Its timerfd in fd mode
+    TimerEntry entry;                // Its place in the wheel in wheel mode
+    int periodMs;
+    long long dueNs;                 // When it should next fire
+} BenchTimer;
+
+/* What a run measured */
+typedef struct {
+    long long expirations;
+    long long wakeups;
+    double setupSeconds;
+    double cpuSeconds;
+    long long late[LATE_BUCKETS + 1];
+} BenchResult;
+
+/* Function prototypes */
+int runFdTimers(BenchTimer *timers, int count, double seconds, BenchResult *result);
+int runWheelTimers(BenchTimer *timers, int count, double seconds, BenchResult *result);
+void noteLate(BenchResult *result, long long dueNs, long long now);
+void printResult(const char *name, const BenchResult *result, int count);
+double latePercentile(const BenchResult *result, double fraction);
+double cpuSeconds(void);
+void usage(const char *program);
+
+/* Main function - entry point of the program */
+int main(int argc, char *argv[]) {
+    static BenchResult fdResult, wheelResult;
+    int count = 10000;
+    int minMs = 50;
+    int maxMs = 200;
+    double seconds = 5;
+    const char *mode = "both";
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--timers") == 0 && i + 1 < argc) {
+            count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) {
+            minMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-ms") == 0 && i + 1 < argc) {
+            maxMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            mode = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (count < 1 || minMs < 1 || maxMs < minMs ||
+        (strcmp(mode, "both") != 0 && strcmp(mode, "fd") != 0 &&
+         strcmp(mode, "wheel") != 0)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    struct rlimit files;
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0) {
+        files.rlim_cur = files.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &files);
+    }
+
+    /* Both modes get the same periods */
+    BenchTimer *timers = calloc(count, sizeof(BenchTimer));
+    if (timers == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    uint64_t rng = 12345;
+    for (int t = 0; t < count; t++) {
+        timers[t].periodMs = minMs + (int)gameRandomBelow(&rng, maxMs - minMs + 1);
+    }
+
+    printf("%d timers, periods %d-%d ms, %.0f s per mode\n", count, minMs, maxMs, seconds);
+    if (strcmp(mode, "wheel") != 0) {
+        if (runFdTimers(timers, count, seconds, &fdResult) != 0) {
+            free(timers);
+            return 1;
+        }
+        printResult("timerfd per timer", &fdResult, count);
+    }
+    if (strcmp(mode, "fd") != 0) {
+        if (runWheelTimers(timers, count, seconds, &wheelResult) != 0) {
+            free(timers);
+            return 1;
+        }
+        printResult("timer wheel", &wheelResult, count);
+    }
+    free(timers);
+    return 0;
+}
+
+/* Fire every timer from its own periodic timerfd */
+int runFdTimers(BenchTimer *timers, int count, double seconds, BenchResult *result) {
+    struct epoll_event events[BATCH_EVENTS];
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (epollFd < 0) {
+        perror("epoll");
+        return 1;
+    }
+
+    double cpuStart = cpuSeconds();
+    long long start = nowNs();
+    for (int t = 0; t < count; t++) {
+        BenchTimer *timer = &timers[t];
+        struct itimerspec period;
+        period.it_interval.tv_sec = timer->periodMs / 1000;
+        period.it_interval.tv_nsec = (long)(timer->periodMs % 1000) * 1000000L;
+        period.it_value = period.it_interval;
+        struct epoll_event event = { .events = EPOLLIN, .data.ptr = timer };
+        timer->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        timer->dueNs = nowNs() + timer->periodMs * 1000000LL;
+        if (timer->fd < 0 || timerfd_settime(timer->fd, 0, &period, NULL) != 0 ||
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, timer->fd, &event) != 0) {
+            fprintf(stderr, "Could not create timer %d (raise ulimit -n)\n", t);
+            for (int c = 0; c <= t; c++) {
+                if (timers[c].fd >= 0) {
+                    close(timers[c].fd);
+                }
+            }
+            close(epollFd);
+            return 1;
+        }
+    }
+    result->setupSeconds = (nowNs() - start) / 1e9;
+
+    long long end = nowNs() + (long long)(seconds * 1e9);
+    while (nowNs() < end) {
+        int ready = epoll_wait(epollFd, events, BATCH_EVENTS, 100);
+        if (ready <= 0) {
+            continue;
+        }
+        result->wakeups++;
+        long long now = nowNs();
+        for (int e = 0; e < ready; e++) {
+            BenchTimer *timer = events[e].data.ptr;
+            uint64_t expirations;
+            if (read(timer->fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+                continue;
+            }
+            for (uint64_t x = 0; x < expirations; x++) {
+                noteLate(result, timer->dueNs, now);
+                timer->dueNs += timer->periodMs * 1000000LL;
+            }
+        }
+    }
+
+    for (int t = 0; t < count; t++) {
+        close(timers[t].fd);
+    }
+    close(epollFd);
+    result->cpuSeconds = cpuSeconds() - cpuStart;
+    return 0;
+}
+
+/* Fire every timer from the wheel, with one timerfd for the thread */
+int runWheelTimers(BenchTimer *timers, int count, double seconds, BenchResult *result) {
+    struct epoll_event events[1];
+    TimerWheel *wheel = malloc(sizeof(TimerWheel));
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    int clockFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    struct epoll_event event = { .events = EPOLLIN };
+
+    if (wheel == NULL || epollFd < 0 || clockFd < 0 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, clockFd, &event) != 0) {
+        fprintf(stderr, "Could not set up the timer wheel\n");
+        free(wheel);
+        return 1;
+    }
+
+    double cpuStart = cpuSeconds();
+    long long start = nowNs();
+    timerWheelInit(wheel, (uint64_t)(start / 1000000));
+    for (int t = 0; t < count; t++) {
+        BenchTimer *timer = &timers[t];
+        timer->dueNs = nowNs() + timer->periodMs * 1000000LL;
+        timerWheelAdd(wheel, &timer->entry, (uint64_t)(timer->dueNs / 1000000));
+    }
+    result->setupSeconds = (nowNs() - start) / 1e9;
+
+    long long end = nowNs() + (long long)(seconds * 1e9);
+    uint64_t armedFor = 0;
+    while (nowNs() < end) {
+        /* Set the clock for the next occupied slot, as the server does */
+        uint64_t due;
+        if (timerWheelNextDue(wheel, &due) && due != armedFor) {
+            struct itimerspec when;
+            memset(&when, 0, sizeof(when));
+            when.it_value.tv_sec = (time_t)(due / 1000);
+            when.it_value.tv_nsec = (long)(due % 1000) * 1000000L;
+            timerfd_settime(clockFd, TFD_TIMER_ABSTIME, &when, NULL);
+            armedFor = due;
+        }
+
+        if (epoll_wait(epollFd, events, 1, 100) <= 0) {
+            continue;
+        }
+        uint64_t expirations;
+        if (read(clockFd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+            continue;
+        }
+        result->wakeups++;
+        armedFor = 0;
+
+        long long now = nowNs();
+        uint64_t nowMs = (uint64_t)(now / 1000000);
+        TimerEntry expired;
+        timerListInit(&expired);
+        timerWheelAdvance(wheel, nowMs, &expired);
+        TimerEntry *entry;
+        while ((entry = timerListPop(&expired)) != NULL) {
+            BenchTimer *timer = (BenchTimer *)((char *)entry - offsetof(BenchTimer, entry));
+            uint64_t steps = 1 + (nowMs - entry->due) / timer->periodMs;
+            for (uint64_t x = 0; x < steps; x++) {
+                noteLate(result, timer->dueNs, now);
+                timer->dueNs += timer->periodMs * 1000000LL;
+            }
+            timerWheelAdd(wheel, entry, entry->due + steps * timer->periodMs);
+        }
+    }
+
+    close(clockFd);
+    close(epollFd);
+    free(wheel);
+    result->cpuSeconds = cpuSeconds() - cpuStart;
+    return 0;
+}
+
+/* Count one expiration and how late it was */
+void noteLate(BenchResult *result, long long dueNs, long long now) {
+    long long late = now > dueNs ? now - dueNs : 0;
+    long long bucket = late / 10000;  // 0.01 ms
+    result->late[bucket < LATE_BUCKETS ? bucket : LATE_BUCKETS]++;
+    result->expirations++;
+}
+
+/* Print one mode's numbers */
+void printResult(const char *name, const BenchResult *result, int count) {
+    printf("\n%s:\n", name);
+    printf("  setup                %.2f ms (%.0f ns per timer)\n",
+           result->setupSeconds * 1e3, result->setupSeconds * 1e9 / count);
+    printf("  expirations          %lld\n", result->expirations);
+    printf("  CPU time             %.3f s (%.0f ns per expiration)\n", result->cpuSeconds,
+           result->expirations > 0 ? result->cpuSeconds * 1e9 / result->expirations : 0.0);
+    printf("  wakeups              %lld (%.1f expirations each)\n", result->wakeups,
+           result->wakeups > 0 ? (double)result->expirations / result->wakeups : 0.0);
+    printf("  late by              p50 %.2f ms, p99 %.2f ms, p99.9 %.2f ms%s\n",
+           latePercentile(result, 0.5), latePercentile(result, 0.99),
+           latePercentile(result, 0.999),
+           result->late[LATE_BUCKETS] > 0 ? " (some over 10 ms)" : "");
+}
+
+/* Lateness in milliseconds below which the given share of expirations fall */
+double latePercentile(const BenchResult *result, double fraction) {
+    long long wanted = (long long)(fraction * result->expirations);
+    long long seen = 0;
+    for (int b = 0; b <= LATE_BUCKETS; b++) {
+        seen += result->late[b];
+        if (seen > wanted) {
+            return (b + 1) * 0.01;
+        }
+    }
+    return LATE_BUCKETS * 0.01;
+}
+
+/* User plus system CPU time of the process, in seconds */
+double cpuSeconds(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+/* Print command line help */
+void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --timers N         Timers to run (default 10000)\n");
+    fprintf(stderr, "  --min-ms N         Shortest period (default 50)\n");
+    fprintf(stderr, "  --max-ms N         Longest period (default 200)\n");
+    fprintf(stderr, "  --seconds N        How long to run each mode (default 5)\n");
+    fprintf(stderr, "  --mode fd|wheel|both  Which schedulers to run (default both)\n");
+}
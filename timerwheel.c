@@ -0,0 +1,157 @@
+/**
+ * Snake Game - Hashed Timer Wheel
+ *
+ * See timerwheel.h. The slot lists are circular with the slot itself as the
+ * head, so linking and unlinking need no special cases. A slot's bit in the
+ * occupied bitmap is cleared when its list becomes empty.
+ */
+
+#include <stddef.h>
+#include "timerwheel.h"
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+
+/* Empty every slot; the wheel starts at the given time */
+void timerWheelInit(TimerWheel *wheel, uint64_t now) {
+    for (int s = 0; s < TIMER_WHEEL_SLOTS; s++) {
+        timerListInit(&wheel->slots[s]);
+    }
+    for (int w = 0; w < TIMER_WHEEL_WORDS; w++) {
+        wheel->occupied[w] = 0;
+    }
+    wheel->now = now;
+    wheel->count = 0;
+}
+
+/* Make an empty list (also used for the list of expired timers) */
+void timerListInit(TimerEntry *list) {
+    list->next = list;
+    list->prev = list;
+}
+
+/* Link an entry in front of a list head */
+static void linkBefore(TimerEntry *head, TimerEntry *entry) {
+    entry->next = head;
+    entry->prev = head->prev;
+    head->prev->next = entry;
+    head->prev = entry;
+}
+
+/* Unlink an entry from whatever list it is in */
+static void unlinkTimer(TimerEntry *entry) {
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+    entry->next = NULL;
+    entry->prev = NULL;
+}
+
+/* Schedule a timer (it must not be scheduled already). A time that has
+ * passed fires on the next advance. */
+void timerWheelAdd(TimerWheel *wheel, TimerEntry *entry, uint64_t due) {
+    uint64_t at = due > wheel->now ? due : wheel->now + 1;
+    int slot = (int)(at & SLOT_MASK);
+
+    entry->due = due;
+    entry->slot = slot;
+    linkBefore(&wheel->slots[slot], entry);
+    wheel->occupied[slot / 64] |= 1ULL << (slot % 64);
+    wheel->count++;
+}
+
+/* Take a timer out of the wheel or the expired list, wherever it is */
+void timerWheelRemove(TimerWheel *wheel, TimerEntry *entry) {
+    if (entry->next == NULL) {
+        return;
+    }
+
+    unlinkTimer(entry);
+    if (entry->slot < 0) {
+        return;  // It was on an expired list
+    }
+
+    /* Once the timer is gone, its slot may be empty */
+    int slot = entry->slot;
+    if (wheel->slots[slot].next == &wheel->slots[slot]) {
+        wheel->occupied[slot / 64] &= ~(1ULL << (slot % 64));
+    }
+    entry->slot = -1;
+    wheel->count--;
+}
+
+/* Move every timer due by the given time onto the expired list. Only slots
+ * with timers are visited; after a long gap, each slot once at most. */
+void timerWheelAdvance(TimerWheel *wheel, uint64_t now, TimerEntry *expired) {
+    if (now <= wheel->now) {
+        return;
+    }
+    uint64_t span = now - wheel->now;
+    if (span > TIMER_WHEEL_SLOTS) {
+        span = TIMER_WHEEL_SLOTS;
+    }
+
+    uint64_t t = wheel->now + 1;
+    uint64_t end = t + span;  // One past the last time to visit
+    while (t < end) {
+        /* Jump to the next occupied slot within the word */
+        int slot = (int)(t & SLOT_MASK);
+        uint64_t bits = wheel->occupied[slot / 64] >> (slot % 64);
+        if (bits == 0) {
+            t += 64 - slot % 64;
+            continue;
+        }
+        t += (uint64_t)__builtin_ctzll(bits);
+        if (t >= end) {
+            break;
+        }
+        slot = (int)(t & SLOT_MASK);
+
+        /* Take the timers that are due; later turns stay */
+        TimerEntry *head = &wheel->slots[slot];
+        TimerEntry *entry = head->next;
+        while (entry != head) {
+            TimerEntry *next = entry->next;
+            if (entry->due <= now) {
+                unlinkTimer(entry);
+                entry->slot = -1;
+                linkBefore(expired, entry);
+                wheel->count--;
+            }
+            entry = next;
+        }
+        if (head->next == head) {
+            wheel->occupied[slot / 64] &= ~(1ULL << (slot % 64));
+        }
+        t++;
+    }
+    wheel->now = now;
+}
+
+/* When the next occupied slot comes round; false if no timers are left.
+ * The timer there may belong to a later turn, which costs one early wakeup. */
+bool timerWheelNextDue(const TimerWheel *wheel, uint64_t *due) {
+    if (wheel->count == 0) {
+        return false;
+    }
+    uint64_t t = wheel->now + 1;
+    for (int scanned = 0; scanned <= TIMER_WHEEL_SLOTS; ) {
+        int slot = (int)(t & SLOT_MASK);
+        uint64_t bits = wheel->occupied[slot / 64] >> (slot % 64);
+        if (bits != 0) {
+            *due = t + (uint64_t)__builtin_ctzll(bits);
+            return true;
+        }
+        scanned += 64 - slot % 64;
+        t += 64 - slot % 64;
+    }
+    return false;
+}
+
+/* Take the first timer off a list, or NULL if it is empty */
+TimerEntry *timerListPop(TimerEntry *list) {
+    TimerEntry *entry = list->next;
+    if (entry == list) {
+        return NULL;
+    }
+    unlinkTimer(entry);
+    return entry;
+}
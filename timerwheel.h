@@ -0,0 +1,55 @@
+/**
+ * Snake Game - Hashed Timer Wheel
+ *
+ * Keeps thousands of game timers in user space, so a server thread needs
+ * one kernel timer instead of one per game. Time is counted in
+ * milliseconds. The wheel has TIMER_WHEEL_SLOTS slots, one per
+ * millisecond; a timer due at time t sits in slot t % TIMER_WHEEL_SLOTS.
+ * Timers more than one turn of the wheel away wait in their slot, and are
+ * skipped until their turn comes round.
+ *
+ * Adding and removing a timer is O(1). Advancing the wheel visits only the
+ * slots that have timers in them, found with a bitmap. timerWheelNextDue()
+ * says when the thread's kernel timer should next fire.
+ *
+ * Timers are embedded in the caller's own structures (no allocation) and
+ * linked into doubly linked lists, so a timer can be removed at any time:
+ * from the wheel, or from the list of expired timers while that list is
+ * being worked through.
+ */
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TIMER_WHEEL_SLOTS 4096  // A power of two; one turn is 4.096 seconds
+#define TIMER_WHEEL_WORDS (TIMER_WHEEL_SLOTS / 64)
+
+/* A timer, embedded in whatever it belongs to */
+typedef struct TimerEntry {
+    struct TimerEntry *next;    // NULL while the timer is not scheduled
+    struct TimerEntry *prev;
+    uint64_t due;               // Time it is due, in milliseconds
+    int slot;                   // Wheel slot it is in, -1 if in no slot
+} TimerEntry;
+
+/* The wheel */
+typedef struct {
+    TimerEntry slots[TIMER_WHEEL_SLOTS];       // List heads (circular)
+    uint64_t occupied[TIMER_WHEEL_WORDS];      // Slots with timers in them
+    uint64_t now;                              // Every slot up to here is done
+    int count;                                 // Timers scheduled
+} TimerWheel;
+
+/* Function prototypes */
+void timerWheelInit(TimerWheel *wheel, uint64_t now);
+void timerListInit(TimerEntry *list);
+void timerWheelAdd(TimerWheel *wheel, TimerEntry *entry, uint64_t due);
+void timerWheelRemove(TimerWheel *wheel, TimerEntry *entry);
+void timerWheelAdvance(TimerWheel *wheel, uint64_t now, TimerEntry *expired);
+bool timerWheelNextDue(const TimerWheel *wheel, uint64_t *due);
+TimerEntry *timerListPop(TimerEntry *list);
+
+#endif /* TIMERWHEEL_H */
@@ -0,0 +1,453 @@
+/**
+ * Snake Game - Bot Tournament (snake-tourney)
+ *
+ * Plays every pair of registered bots against each other and keeps Elo
+ * ratings in a file between runs.
+ *
+ * The core game has a single snake, so a match is a duel on a shared seed:
+ * both bots play the same game (same start, same food sequence for the same
+ * moves) one after the other, and the higher score wins. Equal scores are
+ * decided by who survived longer - or, when both filled the board, by who
+ * did it sooner; if that is equal too, it is a draw.
+ *
+ * Matches run on a pool of threads. Expensive matches (by the bots' cost
+ * hints) are handed out first, so no thread is left with one long match at
+ * the end while the others sit idle. Ratings are updated afterwards in the
+ * original match order, so a run gives the same ratings whatever the thread
+ * timing was - as long as every bot plays the same moves for the same seed.
+ * Bots with a time budget (mcts) do not: how far they search depends on the
+ * clock and the machine's load, so runs that include them can differ.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "game.h"
+#include "bots.h"
+#include "clock.h"
+
+/* Tournament Limits */
+#define TOURNEY_MAX_BOTS    16
+#define TOURNEY_MAX_MATCHES 65536
+#define TOURNEY_MAX_THREADS 256
+#define TOURNEY_MAX_RATINGS 256
+#define ELO_START 1500.0   // Rating of a bot that has never played
+#define ELO_K     16.0     // How far one result moves a rating
+
+/* The game's tick length, for the food-per-minute rate in --stats records */
+#define TICK_SECONDS 0.1
+
+/* One duel and its outcome */
+typedef struct {
+    int index;          // Position in the original schedule
+    int a;              // Bot numbers (into Tourney.bots)
+    int b;
+    uint64_t seed;      // Shared game seed
+    int cost;           // Scheduling estimate
+    int scoreA;
+    int scoreB;
+    int result;         // 1 = a won, 0 = draw, -1 = b won
+} Match;
+
+/* A persisted rating */
+typedef struct {
+    char name[32];
+    double rating;
+    int games;
+    int wins;
+    int losses;
+    int draws;
+} Rating;
+
+/* Everything shared between the match threads */
+typedef struct {
+    const BotType *bots[TOURNEY_MAX_BOTS];
+    int botCount;
+    Match matches[TOURNEY_MAX_MATCHES];
+    int matchCount;
+    int maxTicks;
+    FILE *stats;          // Per-game records (--stats), or NULL
+
+    pthread_mutex_t lock;
+    int nextMatch;
+    double busySeconds;   // Time threads spent playing, summed
+} Tourney;
+
+/* Function prototypes */
+void *matchThread(void *arg);
+void playMatch(const Tourney *tourney, Match *match, Arena *arena);
+int playSide(const Tourney *tourney, const BotType *type, uint64_t seed,
+             Arena *arena, int *ticks, bool *won);
+int loadRatings(const char *path, Rating *ratings);
+bool saveRatings(const char *path, const Rating *ratings, int count);
+Rating *findRating(Rating *ratings, int *count, const char *name);
+void usage(const char *program);
+
+/* Order matches from most to least expensive */
+static int compareCost(const void *a, const void *b) {
+    const Match *ma = a;
+    const Match *mb = b;
+    if (ma->cost != mb->cost) {
+        return mb->cost - ma->cost;
+    }
+    return ma->index - mb->index;
+}
+
+/* Order matches back into schedule order */
+static int compareIndex(const void *a, const void *b) {
+    return ((const Match *)a)->index - ((const Match *)b)->index;
+}
+
+/* Order ratings from best to worst */
+static int compareRating(const void *a, const void *b) {
+    double ra = ((const Rating *)a)->rating;
+    double rb = ((const Rating *)b)->rating;
+    return (ra < rb) - (ra > rb);
+}
+
+/* Main function - entry point of the program */
+int main(int argc, char *argv[]) {
+    static Tourney tourney;
+    static Rating ratings[TOURNEY_MAX_RATINGS];
+    BotOptions botOptions = { NULL, NULL, 5, NULL, 10000, NULL, 1, NULL };
+    const char *botList = NULL;
+    const char *ratingsFile = "snake-elo.txt";
+    const char *statsFile = NULL;
+    int rounds = 10;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t seed = (uint64_t)time(NULL);
+
+    tourney.maxTicks = 5000;
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bots") == 0 && i + 1 < argc) {
+            botList = argv[++i];
+        } else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            tourney.maxTicks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ratings") == 0 && i + 1 < argc) {
+            ratingsFile = argv[++i];
+        } else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            statsFile = argv[++i];
+        } else if (strcmp(argv[i], "--weights") == 0 && i + 1 < argc) {
+            botOptions.weightsFile = argv[++i];
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            botOptions.policyFile = argv[++i];
+        } else if (strcmp(argv[i], "--mcts-ms") == 0 && i + 1 < argc) {
+            botOptions.mctsBudgetMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--plugin") == 0 && i + 1 < argc) {
+            botOptions.pluginFile = argv[++i];
+        } else if (strcmp(argv[i], "--budget-us") == 0 && i + 1 < argc) {
+            botOptions.pluginBudgetUs = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--solved") == 0 && i + 1 < argc) {
+            botOptions.solvedFile = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (threads > TOURNEY_MAX_THREADS) threads = TOURNEY_MAX_THREADS;
+
+    char error[256];
+    if (!configureBots(&botOptions, error, sizeof(error))) {
+        fprintf(stderr, "%s\n", error);
+        return 1;
+    }
+
+    /* Pick the competitors: a comma separated list, or every cheap bot */
+    if (botList != NULL) {
+        char names[1024];
+        snprintf(names, sizeof(names), "%s", botList);
+        for (char *name = strtok(names, ","); name != NULL; name = strtok(NULL, ",")) {
+            const BotType *type = findBot(name);
+            if (type == NULL || !botAvailable(type) ||
+                tourney.botCount == TOURNEY_MAX_BOTS) {
+                fprintf(stderr, "Unknown or unavailable bot: %s\n", name);
+                return 1;
+            }
+            tourney.bots[tourney.botCount++] = type;
+        }
+    } else {
+        for (int i = 0; i < botCount(); i++) {
+            const BotType *type = botAt(i);
+            if (botAvailable(type) && type->cost < 100) {
+                tourney.bots[tourney.botCount++] = type;
+            }
+        }
+    }
+    if (tourney.botCount < 2) {
+        fprintf(stderr, "A tournament needs at least two bots\n");
+        return 1;
+    }
+
+    /* Round robin: every pair plays once per round, each with its own seed */
+    uint64_t seedState = seed ? seed : 1;
+    for (int round = 0; round < rounds; round++) {
+        for (int a = 0; a < tourney.botCount; a++) {
+            for (int b = a + 1; b < tourney.botCount; b++) {
+                if (tourney.matchCount == TOURNEY_MAX_MATCHES) {
+                    break;
+                }
+                Match *match = &tourney.matches[tourney.matchCount];
+                match->index = tourney.matchCount++;
+                match->a = a;
+                match->b = b;
+                match->seed = ((uint64_t)gameRandom(&seedState) << 32) |
+                              gameRandom(&seedState);
+                match->cost = tourney.bots[a]->cost + tourney.bots[b]->cost;
+            }
+        }
+    }
+
+    /* Longest matches first keeps all threads busy until the end */
+    qsort(tourney.matches, tourney.matchCount, sizeof(Match), compareCost);
+
+    printf("%d bots, %d matches on %d threads (seed %llu)\n", tourney.botCount,
+           tourney.matchCount, threads, (unsigned long long)seed);
+
+    if (statsFile != NULL) {
+        tourney.stats = fopen(statsFile, "a");
+        if (tourney.stats == NULL) {
+            fprintf(stderr, "Could not open %s\n", statsFile);
+            return 1;
+        }
+    }
+
+    pthread_t workers[TOURNEY_MAX_THREADS];
+    int started = 0;
+    pthread_mutex_init(&tourney.lock, NULL);
+    double start = secondsNow();
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&workers[started], NULL, matchThread, &tourney) == 0) {
+            started++;
+        }
+    }
+    if (started == 0) {
+        matchThread(&tourney);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    double elapsed = secondsNow() - start;
+    pthread_mutex_destroy(&tourney.lock);
+    if (tourney.stats != NULL) {
+        fclose(tourney.stats);
+    }
+
+    /* Apply the results in schedule order, so the ratings do not depend on
+     * which thread finished first */
+    qsort(tourney.matches, tourney.matchCount, sizeof(Match), compareIndex);
+    int ratingCount = loadRatings(ratingsFile, ratings);
+    for (int i = 0; i < tourney.matchCount; i++) {
+        const Match *match = &tourney.matches[i];
+        Rating *a = findRating(ratings, &ratingCount, tourney.bots[match->a]->name);
+        Rating *b = findRating(ratings, &ratingCount, tourney.bots[match->b]->name);
+        if (a == NULL || b == NULL) {
+            continue;
+        }
+
+        double expected = 1.0 / (1.0 + pow(10.0, (b->rating - a->rating) / 400.0));
+        double actual = match->result > 0 ? 1.0 : match->result < 0 ? 0.0 : 0.5;
+        a->rating += ELO_K * (actual - expected);
+        b->rating -= ELO_K * (actual - expected);
+        a->games++;
+        b->games++;
+        if (match->result > 0) {
+            a->wins++;
+            b->losses++;
+        } else if (match->result < 0) {
+            b->wins++;
+            a->losses++;
+        } else {
+            a->draws++;
+            b->draws++;
+        }
+    }
+
+    qsort(ratings, ratingCount, sizeof(Rating), compareRating);
+    printf("\n%-12s %8s %7s %6s %6s %6s\n", "bot", "elo", "games", "wins",
+           "losses", "draws");
+    for (int i = 0; i < ratingCount; i++) {
+        printf("%-12s %8.1f %7d %6d %6d %6d\n", ratings[i].name, ratings[i].rating,
+               ratings[i].games, ratings[i].wins, ratings[i].losses, ratings[i].draws);
+    }
+    printf("\n%.1f matches/s, worker utilisation %.0f%%\n",
+           tourney.matchCount / elapsed,
+           100.0 * tourney.busySeconds / (elapsed * (started ? started : 1)));
+
+    if (!saveRatings(ratingsFile, ratings, ratingCount)) {
+        fprintf(stderr, "Could not write %s\n", ratingsFile);
+        return 1;
+    }
+    return 0;
+}
+
+/* Match thread: play matches from the queue until it is empty */
+void *matchThread(void *arg) {
+    Tourney *tourney = arg;
+    Arena arena;
+    double busy = 0.0;
+
+    if (!arenaInit(&arena, GAME_ARENA_BYTES)) {
+        return NULL;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&tourney->lock);
+        int next = tourney->nextMatch++;
+        pthread_mutex_unlock(&tourney->lock);
+
+        if (next >= tourney->matchCount) {
+            break;
+        }
+
+        double start = secondsNow();
+        playMatch(tourney, &tourney->matches[next], &arena);
+        busy += secondsNow() - start;
+    }
+
+    pthread_mutex_lock(&tourney->lock);
+    tourney->busySeconds += busy;
+    pthread_mutex_unlock(&tourney->lock);
+
+    arenaFree(&arena);
+    return NULL;
+}
+
+/* Play one game with a bot; returns the score and sets how long it lasted
+ * and whether it filled the board */
+int playSide(const Tourney *tourney, const BotType *type, uint64_t seed,
+             Arena *arena, int *ticks, bool *won) {
+    Game game;
+    void *state = type->create != NULL ? type->create(seed) : NULL;
+    PlayOptions options = { tourney->maxTicks, tourney->stats != NULL, NULL, NULL };
+    int tick = playBotGame(&game, arena, seed, type->chooseMove, state, &options);
+
+    if (type->destroy != NULL) {
+        type->destroy(state);
+    }
+    /* One fprintf() per record, so records from several threads never mix */
+    if (tourney->stats != NULL) {
+        writeGameStats(tourney->stats, &game, TICK_SECONDS, type->name, seed);
+    }
+    *ticks = tick;
+    *won = game.won;
+    return game.snake.size - INITIAL_SIZE;
+}
+
+/* Play both sides of a duel and record who won */
+void playMatch(const Tourney *tourney, Match *match, Arena *arena) {
+    int ticksA;
+    int ticksB;
+    bool wonA;
+    bool wonB;
+
+    match->scoreA = playSide(tourney, tourney->bots[match->a], match->seed,
+                             arena, &ticksA, &wonA);
+    match->scoreB = playSide(tourney, tourney->bots[match->b], match->seed,
+                             arena, &ticksB, &wonB);
+
+    /* A full board is the top score, so equal scores mean both or neither won */
+    if (match->scoreA != match->scoreB) {
+        match->result = match->scoreA > match->scoreB ? 1 : -1;
+    } else if (ticksA != ticksB) {
+        bool aLasted = ticksA > ticksB;
+        match->result = aLasted != (wonA && wonB) ? 1 : -1;
+    } else {
+        match->result = 0;
+    }
+}
+
+/* Read ratings saved by an earlier run (a missing file means no ratings) */
+int loadRatings(const char *path, Rating *ratings) {
+    char line[256];
+    int count = 0;
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        return 0;
+    }
+    while (count < TOURNEY_MAX_RATINGS && fgets(line, sizeof(line), file) != NULL) {
+        Rating *r = &ratings[count];
+        if (line[0] != '#' &&
+            sscanf(line, "%31s %lf %d %d %d %d", r->name, &r->rating, &r->games,
+                   &r->wins, &r->losses, &r->draws) == 6) {
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+/* Write all ratings (via a temporary file, so a crash never loses them) */
+bool saveRatings(const char *path, const Rating *ratings, int count) {
+    char temp[4096];
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+
+    FILE *file = fopen(temp, "w");
+    if (file == NULL) {
+        return false;
+    }
+    fprintf(file, "# name rating games wins losses draws\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "%s %.3f %d %d %d %d\n", ratings[i].name, ratings[i].rating,
+                ratings[i].games, ratings[i].wins, ratings[i].losses, ratings[i].draws);
+    }
+    if (fclose(file) != 0) {
+        return false;
+    }
+    return rename(temp, path) == 0;
+}
+
+/* Find a bot's rating, adding a fresh one if it has never played */
+Rating *findRating(Rating *ratings, int *count, const char *name) {
+    for (int i = 0; i < *count; i++) {
+        if (strcmp(ratings[i].name, name) == 0) {
+            return &ratings[i];
+        }
+    }
+    if (*count == TOURNEY_MAX_RATINGS) {
+        return NULL;
+    }
+
+    Rating *r = &ratings[(*count)++];
+    memset(r, 0, sizeof(Rating));
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->rating = ELO_START;
+    return r;
+}
+
+/* Print command line help */
+void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --bots A,B,...    Bots to enter (default: all cheap bots)\n");
+    fprintf(stderr, "  --rounds N        Round-robin rounds (default 10)\n");
+    fprintf(stderr, "  --threads N       Worker threads (default: one per CPU)\n");
+    fprintf(stderr, "  --seed N          Seed for the match seeds (default: clock)\n");
+    fprintf(stderr, "  --max-ticks N     Tick limit per game (default 5000)\n");
+    fprintf(stderr, "  --ratings FILE    Elo ratings file (default snake-elo.txt)\n");
+    fprintf(stderr, "  --stats FILE      Append every game's statistics as JSON lines\n");
+    fprintf(stderr, "  --weights FILE    Heuristic bot weights\n");
+    fprintf(stderr, "  --policy FILE     Policy bot network\n");
+    fprintf(stderr, "  --mcts-ms N       MCTS bot thinking time per move (default 5)\n");
+    fprintf(stderr, "  --plugin FILE     Plugin bot shared library\n");
+    fprintf(stderr, "  --budget-us N     Plugin bot time per move (default 10000)\n");
+    fprintf(stderr, "  --solved FILE     Solved bot policy table (tiny boards only)\n");
+    fprintf(stderr, "Bots:\n");
+    for (int i = 0; i < botCount(); i++) {
+        fprintf(stderr, "  %-10s %s\n", botAt(i)->name, botAt(i)->description);
+    }
+}
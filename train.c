@@ -0,0 +1,446 @@
+/**
+ * Snake Game - Heuristic Weight Trainer (snake-train)
+ *
+ * Evolves the weights of the heuristic controller with a genetic algorithm:
+ *   1. Every individual in the population is a set of weights.
+ *   2. Each generation, every individual plays the same handful of games
+ *      (common random seeds), so differences in score come from the weights
+ *      and not from luck with the food.
+ *   3. The best individuals are kept, and the rest of the next generation is
+ *      bred from them by crossover and random mutation.
+ *
+ * Games run on the headless core, spread over a pool of threads (one per CPU
+ * by default). After every generation the population is written to a
+ * checkpoint file that --resume can continue from, and whose "best" line can
+ * be loaded by the game with: ./snake --ai heuristic --weights FILE
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "game.h"
+#include "ai.h"
+#include "bots.h"
+#include "clock.h"
+
+/* Trainer Limits */
+#define TRAIN_MAX_POPULATION 1024
+#define TRAIN_MAX_GAMES      256
+#define TRAIN_MAX_THREADS    256
+#define TRAIN_ELITE          2     // Best individuals copied unchanged
+#define TRAIN_TOURNAMENT     3     // Candidates compared when picking a parent
+#define TRAIN_MUTATION_RATE  0.3   // Chance that a weight gets mutated
+#define TRAIN_MUTATION_SIZE  0.3   // Standard deviation of a mutation
+
+/* One candidate set of weights and how well it played */
+typedef struct {
+    HeuristicWeights weights;
+    double fitness;
+} Individual;
+
+/* Everything shared between the evaluation threads */
+typedef struct {
+    Individual population[TRAIN_MAX_POPULATION];
+    int populationSize;
+    uint64_t seeds[TRAIN_MAX_GAMES];  // Game seeds shared by all individuals
+    int gamesPerEval;
+    int maxTicks;
+
+    /* Work queue: job j is game (j % gamesPerEval) of individual
+     * (j / gamesPerEval), handed out under the lock */
+    pthread_mutex_t lock;
+    int nextJob;
+    int jobCount;
+    double scores[TRAIN_MAX_POPULATION * TRAIN_MAX_GAMES];
+    long long ticks;                  // Ticks simulated this generation
+} Trainer;
+
+/* Settings from the command line */
+typedef struct {
+    int population;
+    int generations;
+    int games;
+    int threads;
+    int maxTicks;
+    uint64_t seed;
+    const char *checkpoint;
+    bool resume;
+} TrainOptions;
+
+/* Function prototypes */
+void *evaluateThread(void *arg);
+double playGame(const HeuristicWeights *weights, uint64_t seed, int maxTicks,
+                Arena *arena, long long *ticks);
+int weightsMove(void *state, const Game *game);
+void evaluatePopulation(Trainer *trainer, int threads);
+void breedNextGeneration(Trainer *trainer, uint64_t *rng);
+bool saveCheckpoint(const Trainer *trainer, const char *path, int generation,
+                    uint64_t seed);
+bool loadCheckpoint(Trainer *trainer, const char *path, int *generation,
+                    uint64_t *seed);
+double gaussian(uint64_t *rng);
+double uniform(uint64_t *rng);
+void usage(const char *program);
+
+/* Main function - entry point of the program */
+int main(int argc, char *argv[]) {
+    static Trainer trainer;
+    TrainOptions options = {
+        .population = 64,
+        .generations = 50,
+        .games = 8,
+        .threads = (int)sysconf(_SC_NPROCESSORS_ONLN),
+        .maxTicks = 5000,
+        .seed = (uint64_t)time(NULL),
+        .checkpoint = "snake-train.ckpt",
+        .resume = false,
+    };
+    int firstGeneration = 0;
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--population") == 0 && i + 1 < argc) {
+            options.population = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--generations") == 0 && i + 1 < argc) {
+            options.generations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            options.games = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            options.maxTicks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            options.checkpoint = argv[++i];
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            options.resume = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    /* Keep the settings inside the fixed limits */
+    if (options.population < TRAIN_ELITE + 1 ||
+        options.population > TRAIN_MAX_POPULATION ||
+        options.games < 1 || options.games > TRAIN_MAX_GAMES ||
+        options.maxTicks < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (options.threads < 1) options.threads = 1;
+    if (options.threads > TRAIN_MAX_THREADS) options.threads = TRAIN_MAX_THREADS;
+
+    trainer.populationSize = options.population;
+    trainer.gamesPerEval = options.games;
+    trainer.maxTicks = options.maxTicks;
+    pthread_mutex_init(&trainer.lock, NULL);
+
+    /* Start from a checkpoint, or from mutated copies of the default weights */
+    uint64_t rng = options.seed ? options.seed : 1;
+    if (options.resume) {
+        if (!loadCheckpoint(&trainer, options.checkpoint, &firstGeneration,
+                            &options.seed)) {
+            fprintf(stderr, "Could not resume from %s\n", options.checkpoint);
+            return 1;
+        }
+        rng = options.seed ^ (uint64_t)(firstGeneration + 1) * 0x9E3779B97F4A7C15ULL;
+    } else {
+        for (int i = 0; i < trainer.populationSize; i++) {
+            defaultHeuristicWeights(&trainer.population[i].weights);
+            for (int w = 0; i > 0 && w < HEURISTIC_FEATURES; w++) {
+                trainer.population[i].weights.weight[w] += gaussian(&rng);
+            }
+        }
+    }
+
+    printf("Training %d individuals x %d games on %d threads (seed %llu)\n",
+           trainer.populationSize, trainer.gamesPerEval, options.threads,
+           (unsigned long long)options.seed);
+
+    for (int generation = firstGeneration;
+         generation < firstGeneration + options.generations; generation++) {
+        /* Common random numbers: everyone plays the same games this round */
+        uint64_t seedState =
+            (options.seed + (uint64_t)generation * 0x9E3779B97F4A7C15ULL) | 1;
+        for (int g = 0; g < trainer.gamesPerEval; g++) {
+            trainer.seeds[g] = ((uint64_t)gameRandom(&seedState) << 32) |
+                               gameRandom(&seedState);
+        }
+
+        double start = secondsNow();
+        evaluatePopulation(&trainer, options.threads);
+        double elapsed = secondsNow() - start;
+
+        /* Report how this generation did */
+        double mean = 0.0;
+        int best = 0;
+        for (int i = 0; i < trainer.populationSize; i++) {
+            mean += trainer.population[i].fitness;
+            if (trainer.population[i].fitness > trainer.population[best].fitness) {
+                best = i;
+            }
+        }
+        mean /= trainer.populationSize;
+
+        int evaluations = trainer.populationSize * trainer.gamesPerEval;
+        printf("gen %4d  best %8.2f  mean %8.2f  %9.1f evals/s  %7.2fM ticks/s\n",
+               generation, trainer.population[best].fitness, mean,
+               evaluations / elapsed, trainer.ticks / elapsed / 1e6);
+        fflush(stdout);
+
+        breedNextGeneration(&trainer, &rng);
+        if (!saveCheckpoint(&trainer, options.checkpoint, generation + 1,
+                            options.seed)) {
+            fprintf(stderr, "Could not write checkpoint %s\n", options.checkpoint);
+            return 1;
+        }
+    }
+
+    printf("Best weights saved in %s\n", options.checkpoint);
+    pthread_mutex_destroy(&trainer.lock);
+    return 0;
+}
+
+/* Play one game with the given weights and return its fitness */
+double playGame(const HeuristicWeights *weights, uint64_t seed, int maxTicks,
+                Arena *arena, long long *ticks) {
+    PlayOptions options = { maxTicks, false, NULL, NULL };
+    Game game;
+    int tick = playBotGame(&game, arena, seed, weightsMove, (void *)weights, &options);
+
+    *ticks += tick;
+
+    /* Food is what counts; surviving longer breaks ties */
+    return (game.snake.size - INITIAL_SIZE) + (double)tick / maxTicks;
+}
+
+/* The heuristic's move with the candidate's weights (the state) */
+int weightsMove(void *state, const Game *game) {
+    return heuristicChooseMove(game, state);
+}
+
+/* Evaluation thread: take games from the queue until it is empty */
+void *evaluateThread(void *arg) {
+    Trainer *trainer = arg;
+    Arena arena;
+    long long ticks = 0;
+
+    if (!arenaInit(&arena, GAME_ARENA_BYTES)) {
+        return NULL;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&trainer->lock);
+        int job = trainer->nextJob++;
+        pthread_mutex_unlock(&trainer->lock);
+
+        if (job >= trainer->jobCount) {
+            break;
+        }
+
+        const Individual *individual =
+            &trainer->population[job / trainer->gamesPerEval];
+        trainer->scores[job] = playGame(&individual->weights,
+                                        trainer->seeds[job % trainer->gamesPerEval],
+                                        trainer->maxTicks, &arena, &ticks);
+    }
+
+    pthread_mutex_lock(&trainer->lock);
+    trainer->ticks += ticks;
+    pthread_mutex_unlock(&trainer->lock);
+
+    arenaFree(&arena);
+    return NULL;
+}
+
+/* Play every individual's games on all threads and fill in the fitness */
+void evaluatePopulation(Trainer *trainer, int threads) {
+    pthread_t workers[TRAIN_MAX_THREADS];
+    int started = 0;
+
+    trainer->nextJob = 0;
+    trainer->jobCount = trainer->populationSize * trainer->gamesPerEval;
+    trainer->ticks = 0;
+
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&workers[started], NULL, evaluateThread, trainer) == 0) {
+            started++;
+        }
+    }
+    /* Without any threads, do the work here */
+    if (started == 0) {
+        evaluateThread(trainer);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    for (int i = 0; i < trainer->populationSize; i++) {
+        double total = 0.0;
+        for (int g = 0; g < trainer->gamesPerEval; g++) {
+            total += trainer->scores[i * trainer->gamesPerEval + g];
+        }
+        trainer->population[i].fitness = total / trainer->gamesPerEval;
+    }
+}
+
+/* Order individuals from best to worst fitness */
+static int compareFitness(const void *a, const void *b) {
+    double fa = ((const Individual *)a)->fitness;
+    double fb = ((const Individual *)b)->fitness;
+    return (fa < fb) - (fa > fb);
+}
+
+/* Pick a parent: the fittest of a few random individuals */
+static const Individual *pickParent(const Trainer *trainer, uint64_t *rng) {
+    const Individual *best = NULL;
+    for (int i = 0; i < TRAIN_TOURNAMENT; i++) {
+        const Individual *candidate =
+            &trainer->population[gameRandom(rng) % trainer->populationSize];
+        if (best == NULL || candidate->fitness > best->fitness) {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+/* Replace the population with the elite plus mutated children */
+void breedNextGeneration(Trainer *trainer, uint64_t *rng) {
+    static Individual next[TRAIN_MAX_POPULATION];
+
+    qsort(trainer->population, trainer->populationSize, sizeof(Individual),
+          compareFitness);
+
+    for (int i = 0; i < trainer->populationSize; i++) {
+        if (i < TRAIN_ELITE) {
+            next[i] = trainer->population[i];
+            continue;
+        }
+
+        const Individual *mother = pickParent(trainer, rng);
+        const Individual *father = pickParent(trainer, rng);
+        for (int w = 0; w < HEURISTIC_FEATURES; w++) {
+            /* Uniform crossover, then an occasional Gaussian nudge */
+            float weight = (gameRandom(rng) & 1) ? mother->weights.weight[w]
+                                                 : father->weights.weight[w];
+            if (uniform(rng) < TRAIN_MUTATION_RATE) {
+                weight += TRAIN_MUTATION_SIZE * gaussian(rng);
+            }
+            next[i].weights.weight[w] = weight;
+        }
+        next[i].fitness = 0.0;
+    }
+
+    memcpy(trainer->population, next, trainer->populationSize * sizeof(Individual));
+}
+
+/* Write the population to a checkpoint (via a temporary file, so a crash
+ * while saving never destroys the previous checkpoint) */
+bool saveCheckpoint(const Trainer *trainer, const char *path, int generation,
+                    uint64_t seed) {
+    char temp[4096];
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+
+    FILE *file = fopen(temp, "w");
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, "# snake-train checkpoint\n");
+    fprintf(file, "generation %d\n", generation);
+    fprintf(file, "seed %llu\n", (unsigned long long)seed);
+    fprintf(file, "fitness %.6f\n", trainer->population[0].fitness);
+
+    /* The population is sorted, so the first individual is the best one */
+    fprintf(file, "best");
+    for (int w = 0; w < HEURISTIC_FEATURES; w++) {
+        fprintf(file, " %.6f", trainer->population[0].weights.weight[w]);
+    }
+    fprintf(file, "\n");
+
+    for (int i = 0; i < trainer->populationSize; i++) {
+        fprintf(file, "individual");
+        for (int w = 0; w < HEURISTIC_FEATURES; w++) {
+            fprintf(file, " %.6f", trainer->population[i].weights.weight[w]);
+        }
+        fprintf(file, "\n");
+    }
+
+    if (fclose(file) != 0) {
+        return false;
+    }
+    return rename(temp, path) == 0;
+}
+
+/* Read a checkpoint written by saveCheckpoint() */
+bool loadCheckpoint(Trainer *trainer, const char *path, int *generation,
+                    uint64_t *seed) {
+    char line[512];
+    int count = 0;
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        unsigned long long value;
+
+        if (sscanf(line, "generation %d", generation) == 1) {
+            continue;
+        }
+        if (sscanf(line, "seed %llu", &value) == 1) {
+            *seed = value;
+            continue;
+        }
+        if (strncmp(line, "individual ", 11) == 0 && count < trainer->populationSize) {
+            char *cursor = line + 11;
+            for (int w = 0; w < HEURISTIC_FEATURES; w++) {
+                trainer->population[count].weights.weight[w] = strtof(cursor, &cursor);
+            }
+            count++;
+        }
+    }
+    fclose(file);
+
+    /* A smaller saved population is topped up with copies of its best */
+    for (int i = count; count > 0 && i < trainer->populationSize; i++) {
+        trainer->population[i] = trainer->population[i % count];
+    }
+    return count > 0;
+}
+
+/* Uniform random number in [0, 1) */
+double uniform(uint64_t *rng) {
+    return gameRandom(rng) / 4294967296.0;
+}
+
+/* Normally distributed random number (Box-Muller) */
+double gaussian(uint64_t *rng) {
+    double u = uniform(rng) + 1e-12;
+    double v = uniform(rng);
+    return sqrt(-2.0 * log(u)) * cos(6.283185307179586 * v);
+}
+
+/* Print command line help */
+void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --population N    Individuals per generation (default 64, max %d)\n",
+            TRAIN_MAX_POPULATION);
+    fprintf(stderr, "  --generations N   Generations to run (default 50)\n");
+    fprintf(stderr, "  --games N         Games per individual (default 8, max %d)\n",
+            TRAIN_MAX_GAMES);
+    fprintf(stderr, "  --threads N       Worker threads (default: one per CPU)\n");
+    fprintf(stderr, "  --max-ticks N     Tick limit per game (default 5000)\n");
+    fprintf(stderr, "  --seed N          Base random seed (default: clock)\n");
+    fprintf(stderr, "  --checkpoint FILE Checkpoint file (default snake-train.ckpt)\n");
+    fprintf(stderr, "  --resume          Continue from the checkpoint file\n");
+}
@@ -0,0 +1,119 @@
+/**
+ * Snake Game - Shared Transposition Table
+ *
+ * See ttable.h. An entry is packed into one word as
+ *
+ *   bits 32-63  value (the float's bits)
+ *   bits 16-31  count
+ *   bits  8-15  depth
+ *   bits  0-7   generation of the search that stored it (never 0, so a
+ *               zeroed slot never looks current)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include "ttable.h"
+
+/* Pack and unpack an entry */
+static uint64_t packEntry(const TableEntry *entry, unsigned generation) {
+    uint32_t bits;
+    int count = entry->count < TABLE_MAX_COUNT ? entry->count : TABLE_MAX_COUNT;
+    int depth = entry->depth < 255 ? entry->depth : 255;
+
+    memcpy(&bits, &entry->value, sizeof(bits));
+    return (uint64_t)bits << 32 | (uint64_t)(count < 0 ? 0 : count) << 16 |
+           (uint64_t)(depth < 0 ? 0 : depth) << 8 | (generation & 0xFF);
+}
+
+static void unpackEntry(uint64_t data, TableEntry *entry) {
+    uint32_t bits = (uint32_t)(data >> 32);
+    memcpy(&entry->value, &bits, sizeof(bits));
+    entry->count = (int)((data >> 16) & 0xFFFF);
+    entry->depth = (int)((data >> 8) & 0xFF);
+}
+
+/* Make a table of about 'bytes' bytes (rounded down to a power of two
+ * buckets, at least one) */
+bool transTableInit(TransTable *table, size_t bytes) {
+    size_t buckets = 1;
+    void *memory;
+
+    while (buckets * 2 * sizeof(TableBucket) <= bytes) {
+        buckets *= 2;
+    }
+    if (posix_memalign(&memory, sizeof(TableBucket), buckets * sizeof(TableBucket)) != 0) {
+        table->buckets = NULL;
+        return false;
+    }
+    memset(memory, 0, buckets * sizeof(TableBucket));
+    table->buckets = memory;
+    table->mask = buckets - 1;
+    table->generation = 1;
+    return true;
+}
+
+void transTableFree(TransTable *table) {
+    free(table->buckets);
+    table->buckets = NULL;
+}
+
+/* Start a new search: what earlier searches stored reads as empty. Call it
+ * while no thread is using the table. */
+void transTableNewSearch(TransTable *table) {
+    table->generation = (table->generation + 1) & 0xFF;
+    if (table->generation == 0) {
+        table->generation = 1;
+    }
+}
+
+/* Look a state up; true (and the entry) if this search has stored it */
+bool transTableProbe(const TransTable *table, uint64_t key, TableEntry *entry,
+                     TableStats *stats) {
+    const TableBucket *bucket = &table->buckets[key & table->mask];
+
+    stats->probes++;
+    for (int i = 0; i < TABLE_BUCKET_SLOTS; i++) {
+        uint64_t data = __atomic_load_n(&bucket->slot[i].data, __ATOMIC_RELAXED);
+        uint64_t check = __atomic_load_n(&bucket->slot[i].check, __ATOMIC_RELAXED);
+        if ((check ^ data) == key && (data & 0xFF) == table->generation) {
+            unpackEntry(data, entry);
+            stats->hits++;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Store a state's entry, over its old one if it has one, otherwise over
+ * the slot with the least search behind it */
+void transTableStore(TransTable *table, uint64_t key, const TableEntry *entry,
+                     TableStats *stats) {
+    TableBucket *bucket = &table->buckets[key & table->mask];
+    int victim = 0;
+    int victimDepth = 256;
+
+    for (int i = 0; i < TABLE_BUCKET_SLOTS; i++) {
+        uint64_t data = __atomic_load_n(&bucket->slot[i].data, __ATOMIC_RELAXED);
+        uint64_t check = __atomic_load_n(&bucket->slot[i].check, __ATOMIC_RELAXED);
+        if ((check ^ data) == key) {
+            victim = i;
+            victimDepth = -1;
+            break;
+        }
+        int depth = (data & 0xFF) == table->generation ? (int)((data >> 8) & 0xFF) : -1;
+        if (depth < victimDepth) {
+            victim = i;
+            victimDepth = depth;
+        }
+    }
+
+    uint64_t data = packEntry(entry, table->generation);
+    stats->stores++;
+    if (victimDepth >= 0) {
+        stats->evictions++;
+    }
+    __atomic_store_n(&bucket->slot[victim].data, data, __ATOMIC_RELAXED);
+    __atomic_store_n(&bucket->slot[victim].check, key ^ data, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,74 @@
+/**
+ * Snake Game - Shared Transposition Table
+ *
+ * A fixed-size table of search results keyed by the game's state hash
+ * (gameHash()), shared by all the threads of a search without any locks.
+ *
+ * Every slot is two 64-bit words: the packed entry, and the key XORed with
+ * it. Threads read and write the words with plain (relaxed atomic) loads
+ * and stores, so two threads writing the same slot at once can leave it
+ * torn: one thread's entry with the other's check word. A reader only
+ * accepts a slot whose check word XORed with its entry gives back the key
+ * it is looking for, so a torn slot simply reads as a miss. Updates can be
+ * lost that way, which a search can live with; wrong answers it could not.
+ *
+ * Slots come in buckets of four that fill one 64-byte cache line. A key
+ * maps to one bucket; storing a new key there replaces the entry with the
+ * least search behind it (replace by depth), where entries left from an
+ * earlier search count as empty. Each thread counts its own probes and
+ * hits in a TableStats of its own, so the counters never bounce between
+ * cores either.
+ */
+
+#ifndef TTABLE_H
+#define TTABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TABLE_BUCKET_SLOTS 4     // Slots per 64-byte bucket
+#define TABLE_MAX_COUNT    65535 // Counts saturate here
+
+/* What is stored for a state */
+typedef struct {
+    float value;        // Mean result of the searches from the state
+    int count;          // How many results the mean is over
+    int depth;          // How much search is behind it (0-255); kept on conflicts
+} TableEntry;
+
+/* One slot: the packed entry and its check word (key ^ entry) */
+typedef struct {
+    uint64_t check;
+    uint64_t data;
+} TableSlot;
+
+typedef struct {
+    TableSlot slot[TABLE_BUCKET_SLOTS];
+} __attribute__((aligned(64))) TableBucket;
+
+/* The table */
+typedef struct {
+    TableBucket *buckets;
+    uint64_t mask;              // Bucket count - 1 (a power of two)
+    unsigned generation;        // Bumped for every new search (8 bits are kept)
+} TransTable;
+
+/* One thread's counters */
+typedef struct {
+    long long probes;
+    long long hits;
+    long long stores;
+    long long evictions;        // Stores that pushed out a current entry of another key
+} TableStats;
+
+/* Function prototypes */
+bool transTableInit(TransTable *table, size_t bytes);
+void transTableFree(TransTable *table);
+void transTableNewSearch(TransTable *table);
+bool transTableProbe(const TransTable *table, uint64_t key, TableEntry *entry,
+                     TableStats *stats);
+void transTableStore(TransTable *table, uint64_t key, const TableEntry *entry,
+                     TableStats *stats);
+
+#endif /* TTABLE_H */
@@ -0,0 +1,205 @@
+/**
+ * Snake Game - Transposition Table Benchmark (snake-ttbench)
+ *
+ * Measures how the shared transposition table (ttable.h) scales with the
+ * number of threads using it at once. Every thread runs the same mix the
+ * MCTS search does: look a state up, and store a result for it when it was
+ * missing or is still being averaged. The states are drawn from one key
+ * space shared by all threads, so they keep hitting each other's entries
+ * (and, now and then, writing the same slot at the same time).
+ *
+ * Every value stored is a function of its key, so a reader can tell if it
+ * ever got back an entry that was not written for its key; the XOR check
+ * words should make that impossible, and any such read is reported.
+ *
+ * The thread counts run are 1, 2, 4, ... up to --threads. For each one the
+ * table starts empty, and the total operations per second, the speedup
+ * over one thread and the hit rate are printed.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "game.h"
+#include "ttable.h"
+#include "clock.h"
+
+#define BENCH_MAX_THREADS 256
+
+/* One thread's work and counters, a cache line of its own */
+typedef struct {
+    pthread_t thread;
+    TransTable *table;
+    pthread_barrier_t *ready;
+    uint64_t rng;
+    long long ops;
+    long long keys;
+    TableStats stats;
+    long long wrong;                 // Hits whose value was not the key's
+} __attribute__((aligned(64))) BenchThread;
+
+/* Function prototypes */
+void *benchThread(void *arg);
+uint64_t benchKey(long long index);
+float keyValue(uint64_t key);
+double runThreads(TransTable *table, BenchThread *threads, int count,
+                  long long ops, long long keys);
+void usage(const char *program);
+
+/* Main function - entry point of the program */
+int main(int argc, char *argv[]) {
+    static BenchThread threads[BENCH_MAX_THREADS];
+    int maxThreads = 8;
+    long long ops = 4000000;
+    long long keys = 200000;
+    int megabytes = 4;
+
+    /* Parse command line options */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            maxThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ops") == 0 && i + 1 < argc) {
+            ops = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--keys") == 0 && i + 1 < argc) {
+            keys = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--mb") == 0 && i + 1 < argc) {
+            megabytes = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (maxThreads < 1 || maxThreads > BENCH_MAX_THREADS || ops < 1 || keys < 1 ||
+        megabytes < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    TransTable table;
+    if (!transTableInit(&table, (size_t)megabytes << 20)) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    printf("%d MB table (%llu buckets), %lld keys, %lld operations per thread\n\n",
+           megabytes, (unsigned long long)table.mask + 1, keys, ops);
+    printf("threads     Mops/s   speedup   hit rate   evictions   bad reads\n");
+
+    double single = 0.0;
+    for (int count = 1;; count = count * 2 < maxThreads ? count * 2 : maxThreads) {
+        double rate = runThreads(&table, threads, count, ops, keys);
+        if (rate < 0) {
+            transTableFree(&table);
+            return 1;
+        }
+        if (count == 1) {
+            single = rate;
+        }
+
+        TableStats total = { 0, 0, 0, 0 };
+        long long wrong = 0;
+        for (int t = 0; t < count; t++) {
+            total.probes += threads[t].stats.probes;
+            total.hits += threads[t].stats.hits;
+            total.evictions += threads[t].stats.evictions;
+            wrong += threads[t].wrong;
+        }
+        printf("%7d %10.2f %8.2fx %9.1f%% %11lld %11lld\n", count, rate / 1e6,
+               rate / single, 100.0 * total.hits / total.probes, total.evictions, wrong);
+
+        if (count == maxThreads) {
+            break;
+        }
+    }
+
+    transTableFree(&table);
+    return 0;
+}
+
+/* Run the mix on 'count' threads over a fresh table; operations per second */
+double runThreads(TransTable *table, BenchThread *threads, int count,
+                  long long ops, long long keys) {
+    pthread_barrier_t ready;
+
+    memset(table->buckets, 0, (table->mask + 1) * sizeof(TableBucket));
+    transTableNewSearch(table);
+    pthread_barrier_init(&ready, NULL, count + 1);
+
+    for (int t = 0; t < count; t++) {
+        BenchThread *thread = &threads[t];
+        memset(&thread->stats, 0, sizeof(thread->stats));
+        thread->table = table;
+        thread->ready = &ready;
+        thread->rng = 0x9E3779B97F4A7C15ULL * (t + 1);
+        thread->ops = ops;
+        thread->keys = keys;
+        thread->wrong = 0;
+        if (pthread_create(&thread->thread, NULL, benchThread, thread) != 0) {
+            fprintf(stderr, "Could not start thread %d\n", t);
+            exit(1);
+        }
+    }
+
+    pthread_barrier_wait(&ready);
+    double start = secondsNow();
+    for (int t = 0; t < count; t++) {
+        pthread_join(threads[t].thread, NULL);
+    }
+    double seconds = secondsNow() - start;
+
+    pthread_barrier_destroy(&ready);
+    return seconds > 0 ? (double)ops * count / seconds : -1.0;
+}
+
+/* One thread: probe, and store when the state is new or still averaging */
+void *benchThread(void *arg) {
+    BenchThread *thread = arg;
+    TransTable *table = thread->table;
+
+    pthread_barrier_wait(thread->ready);
+    for (long long i = 0; i < thread->ops; i++) {
+        uint64_t key = benchKey((long long)gameRandomBelow(&thread->rng, (uint32_t)thread->keys));
+        TableEntry entry;
+
+        if (transTableProbe(table, key, &entry, &thread->stats)) {
+            if (entry.value != keyValue(key)) {
+                thread->wrong++;
+            }
+            if (entry.count >= 4) {
+                continue;
+            }
+            entry.count++;
+        } else {
+            entry.count = 1;
+        }
+        entry.value = keyValue(key);
+        entry.depth = (int)(key >> 59);
+        transTableStore(table, key, &entry, &thread->stats);
+    }
+    return NULL;
+}
+
+/* The state hash for a key index (spread like real state hashes) */
+uint64_t benchKey(long long index) {
+    return zobristKey(ZOBRIST_BODY, (int)(index % CELL_COUNT)) ^
+           zobristKey(ZOBRIST_HEAD, (int)(index / CELL_COUNT % CELL_COUNT)) ^
+           zobristKey(ZOBRIST_SIZE, (int)(index / CELL_COUNT / CELL_COUNT));
+}
+
+/* The value every thread stores for a key */
+float keyValue(uint64_t key) {
+    return (float)(key & 0xFFFF) / 65536.0f;
+}
+
+/* Print command line help */
+void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --threads N        Most threads to run (default 8)\n");
+    fprintf(stderr, "  --ops N            Operations per thread (default 4000000)\n");
+    fprintf(stderr, "  --keys N           Distinct states (default 200000)\n");
+    fprintf(stderr, "  --mb N             Table size in megabytes (default 4)\n");
+}